@@ -0,0 +1,72 @@
+/**
+ * font.c - 14-segment font data and glyph geometry
+ *
+ * Copyright (c) 2025 Olivier Coz
+ *
+ * This software is released under the MIT License.
+ * See the LICENSE file for details.
+ */
+
+#include "font.h"
+
+#include <math.h>
+
+// Define M_PI if it's not already defined by math.h
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+
+// --- Font Data ---
+
+// Segments are bit-packed: 0=A, 1=B, 2=C, 3=D, 4=E, 5=F, 6=G1, 7=G2, 8=H, 9=I, 10=J, 11=K, 12=L, 13=M
+const uint16_t FourteenSegmentASCII[SUPPORTED_CHARS] = {
+    0b00000000000000, 0b10000000000110, 0b00001000000010, 0b01001011001110, 0b01001011101101, 0b11111111100100, 0b10001101011001, 0b00001000000000,
+    0b10010000000000, 0b00100100000000, 0b11111111000000, 0b01001011000000, 0b00100000000000, 0b00000011000000, 0b10000000000000, 0b00110000000000,
+    0b00110000111111, 0b00010000000110, 0b00000011011011, 0b00000010001111, 0b00000011100110, 0b10000001101001, 0b00000011111101, 0b00000000000111,
+    0b00000011111111, 0b00000011101111, 0b01001000000000, 0b00101000000000, 0b10010001000000, 0b00000011001000, 0b00100110000000, 0b11000010000011,
+    0b00001010111011, 0b00000011110111, 0b01001010001111, 0b00000000111001, 0b01001000001111, 0b00000001111001, 0b00000001110001, 0b00000010111101,
+    0b00000011110110, 0b01001000001001, 0b00000000011110, 0b10010001110000, 0b00000000111000, 0b00010100110110, 0b10000100110110, 0b00000000111111,
+    0b00000011110011, 0b10000000111111, 0b10000011110011, 0b00000011101101, 0b01001000000001, 0b00000000111110, 0b00110000110000, 0b10100000110110,
+    0b10110100000000, 0b00000011101110, 0b00110000001001, 0b00000000111001, 0b10000100000000, 0b00000000001111, 0b10100000000000, 0b00000000001000,
+    0b00000100000000, 0b01000001011000, 0b10000001111000, 0b00000011011000, 0b00100010001110, 0b00100001011000, 0b01010011000000, 0b00010010001110,
+    0b01000001110000, 0b01000000000000, 0b00101000010000, 0b11011000000000, 0b00000000110000, 0b01000011010100, 0b01000001010000, 0b00000011011100,
+    0b00000101110000, 0b00010010000110, 0b00000001010000, 0b10000010001000, 0b00000001111000, 0b00000000011100, 0b00100000010000, 0b10100000010100,
+    0b10110100000000, 0b00001010001110, 0b00100001001000, 0b00100101001001, 0b01001000000000, 0b10010010001001, 0b00110011000000, 0b00000000000000
+};
+
+
+// --- Glyph Geometry ---
+
+/**
+ * @brief Lays out the 14 segments of a glyph with the given cell size.
+ * Fills in each segment's center, orientation and length (without the pointy
+ * ends) in character-local space, where the glyph is centered on the origin.
+ * @param W, H The character width and height.
+ * @param seg_w The segment width, which the lengths leave room for at the joints.
+ */
+void font_layout(float W, float H, float seg_w, SegmentDef seg_defs[NUM_SEGMENTS], float segment_lengths[NUM_SEGMENTS]) {
+    const float quarter_w = W / 4.0f;
+    const float quarter_h = H / 4.0f;
+    const float diag_angle_rad = atan2f(quarter_h, quarter_w);
+
+    SegmentDef seg_defs_init[NUM_SEGMENTS] = {
+        {0, H/2, 0}, {W/2, H/4, 90}, {W/2, -H/4, 90}, {0, -H/2, 0}, {-W/2, -H/4, 90}, {-W/2, H/4, 90},
+        {-quarter_w, 0, 0}, {quarter_w, 0, 0}, {-quarter_w, quarter_h, -diag_angle_rad*180.0f/M_PI}, {0, quarter_h, 90}, {quarter_w, quarter_h, diag_angle_rad*180.0f/M_PI},
+        {-quarter_w, -quarter_h, diag_angle_rad*180.0f/M_PI}, {0, -quarter_h, 90}, {quarter_w, -quarter_h, -diag_angle_rad*180.0f/M_PI}
+    };
+    for(int i = 0; i < NUM_SEGMENTS; ++i) {
+        seg_defs[i] = seg_defs_init[i];
+        seg_defs[i].rot_z_rad = seg_defs[i].rot_z_rad * M_PI / 180.0f; // Convert degrees to radians
+        seg_defs[i].cos_ra = cosf(seg_defs[i].rot_z_rad);
+        seg_defs[i].sin_ra = sinf(seg_defs[i].rot_z_rad);
+    }
+
+    const float horiz_len = W / 2.0f - seg_w / 2.0f, vert_outer_len = H / 2.0f - seg_w;
+    const float vert_inner_len = quarter_h - seg_w / 2.0f, diag_len = sqrtf(quarter_w * quarter_w + quarter_h * quarter_h) - seg_w;
+    const float lengths[NUM_SEGMENTS] = {
+        horiz_len, vert_outer_len, vert_outer_len, horiz_len, vert_outer_len, vert_outer_len,
+        horiz_len, horiz_len, diag_len, vert_inner_len, diag_len, diag_len, vert_inner_len, diag_len
+    };
+    for (int i = 0; i < NUM_SEGMENTS; i++) segment_lengths[i] = lengths[i];
+}
@@ -0,0 +1,33 @@
+/**
+ * font.h - 14-segment font data and glyph geometry
+ *
+ * Copyright (c) 2025 Olivier Coz
+ *
+ * This software is released under the MIT License.
+ * See the LICENSE file for details.
+ */
+
+#ifndef HOLO_FONT_H
+#define HOLO_FONT_H
+
+#include <stdint.h>
+
+#define NUM_SEGMENTS 14
+#define ASCII_OFFSET 32
+#define SUPPORTED_CHARS 96 // Number of characters in our font data (from ASCII 32 to 127)
+
+/**
+ * @brief Defines a single segment's position and orientation.
+ * Pre-calculating the rotation sine and cosine saves computation in the render loop.
+ */
+typedef struct {
+    float pos_x, pos_y;
+    float rot_z_rad;
+    float cos_ra, sin_ra; // Pre-calculated cos and sin of rot_z_rad
+} SegmentDef;
+
+extern const uint16_t FourteenSegmentASCII[SUPPORTED_CHARS];
+
+void font_layout(float W, float H, float seg_w, SegmentDef seg_defs[NUM_SEGMENTS], float segment_lengths[NUM_SEGMENTS]);
+
+#endif // HOLO_FONT_H
@@ -0,0 +1,75 @@
+/**
+ * frames.c - Lock-free hand-off of finished frames to presenters
+ *
+ * Copyright (c) 2025 Olivier Coz
+ *
+ * This software is released under the MIT License.
+ * See the LICENSE file for details.
+ */
+
+#include "frames.h"
+
+#include <string.h>
+
+
+// --- Frame Ring ---
+
+/**
+ * @brief Arena space frame_ring_resize needs for a screen of the given size.
+ */
+size_t frame_ring_arena_size(int cols, int rows) {
+    return FRAME_RING_SLOTS * arena_align((size_t)cols * rows);
+}
+
+/**
+ * @brief Carves the slots for a new screen size out of the arena and empties the ring.
+ * Presenters must not be reading the ring meanwhile: their old slots are gone.
+ */
+void frame_ring_resize(FrameRing* ring, Arena* arena, int cols, int rows) {
+    for (int i = 0; i < FRAME_RING_SLOTS; i++) {
+        ring->slots[i].cells = arena_alloc(arena, (size_t)cols * rows);
+        atomic_store_explicit(&ring->slots[i].seq, 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&ring->published, 0, memory_order_release);
+    ring->cols = cols;
+    ring->rows = rows;
+}
+
+/**
+ * @brief Copies a finished frame into the ring and makes it the latest. Never waits for readers.
+ * Only one thread may publish.
+ */
+void frame_ring_publish(FrameRing* ring, const char* cells) {
+    uint64_t frame = atomic_load_explicit(&ring->published, memory_order_relaxed) + 1;
+    FrameSlot* slot = &ring->slots[frame % FRAME_RING_SLOTS];
+
+    atomic_store_explicit(&slot->seq, 2 * frame - 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release); // The odd sequence is visible before any new cell
+    memcpy(slot->cells, cells, (size_t)ring->cols * ring->rows);
+    atomic_store_explicit(&slot->seq, 2 * frame, memory_order_release);
+    atomic_store_explicit(&ring->published, frame, memory_order_release);
+}
+
+/**
+ * @brief Copies the latest complete frame into `cells` if it is newer than `*frame`.
+ * Safe to call from any number of threads at once, concurrently with
+ * frame_ring_publish.
+ * @param frame The number of the last frame this reader took; updated on success.
+ * @return 1 if a newer frame was copied, 0 if there is none yet.
+ */
+int frame_ring_latest(FrameRing* ring, char* cells, uint64_t* frame) {
+    for (;;) {
+        uint64_t latest = atomic_load_explicit(&ring->published, memory_order_acquire);
+        if (latest == 0 || latest == *frame) return 0;
+        FrameSlot* slot = &ring->slots[latest % FRAME_RING_SLOTS];
+
+        // The slot already holds a newer frame, or is being rewritten: start over from the newest
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != 2 * latest) continue;
+        memcpy(cells, slot->cells, (size_t)ring->cols * ring->rows);
+        atomic_thread_fence(memory_order_acquire); // The copy completes before the sequence is checked again
+        if (atomic_load_explicit(&slot->seq, memory_order_relaxed) == 2 * latest) {
+            *frame = latest;
+            return 1;
+        }
+    }
+}
@@ -0,0 +1,50 @@
+/**
+ * frames.h - Lock-free hand-off of finished frames to presenters
+ *
+ * Copyright (c) 2025 Olivier Coz
+ *
+ * This software is released under the MIT License.
+ * See the LICENSE file for details.
+ */
+
+#ifndef HOLO_FRAMES_H
+#define HOLO_FRAMES_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#define FRAME_RING_SLOTS 3 // The latest frame, one a slow reader may still copy, and the one being written
+
+/**
+ * @brief One frame of the ring, guarded by a sequence lock.
+ * `seq` is 2n while the slot holds frame n, and 2n - 1 while frame n is
+ * being written into it, so a reader can tell both a torn copy and a slot
+ * that moved on to a newer frame.
+ */
+typedef struct {
+    _Alignas(64) atomic_uint_fast64_t seq;
+    char* cells; // cols * rows characters
+} FrameSlot;
+
+/**
+ * @brief Single-producer, multi-consumer ring of finished frames.
+ * The renderer publishes every frame without ever waiting; each presenter
+ * (terminal, recorder, exporter...) copies out the latest complete frame
+ * whenever it is ready for one, and retries in the rare case the renderer
+ * lapped the ring during its copy. Frames a presenter was too slow for are
+ * simply skipped.
+ */
+typedef struct {
+    FrameSlot slots[FRAME_RING_SLOTS];
+    _Alignas(64) atomic_uint_fast64_t published; // Frames published so far; the latest is frame `published`
+    int cols, rows;
+} FrameRing;
+
+size_t frame_ring_arena_size(int cols, int rows);
+void frame_ring_resize(FrameRing* ring, Arena* arena, int cols, int rows);
+void frame_ring_publish(FrameRing* ring, const char* cells);
+int frame_ring_latest(FrameRing* ring, char* cells, uint64_t* frame);
+
+#endif // HOLO_FRAMES_H
@@ -27,6 +27,7 @@
  *    https://github.com/dmadison/LED-Segment-ASCII/
  */
 
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -34,20 +35,14 @@
 #include <unistd.h>
 #include <stdint.h>
 #include <getopt.h>
-#include <signal.h> // For graceful exit and window resizing
-
-// For precise timing and date/time functions
-#ifdef _WIN32
-#include <windows.h>
 #include <time.h> // For time() and strftime()
-#else
-#include <time.h> // For nanosleep, clock_gettime, time(), and strftime()
-#endif
 
-// For M_PI on some compilers
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
+#include "platform.h"
+#include "font.h"
+#include "render.h"
+#include "present.h"
+#include "mesh.h"
+#include "timeline.h"
 
 // --- Constants & Configuration ---
 #define DEFAULT_SPEED_A         0.04f
@@ -65,264 +60,493 @@
 #define DEFAULT_ASCII_PALETTE         ".,-~:;=!*#$@"
 #define DEFAULT_DENSITY         0.1f
 #define DEFAULT_TIME_FORMAT     "%H:%M"
+#define DEFAULT_KEYFRAME_INTERVAL 1 // Render every frame in full (no interpolation)
+#define DEFAULT_TRANSITION_FRAMES 12 // Frames a changing character takes to become the new one (-D)
 
-#define NUM_SEGMENTS 14
-#define ASCII_OFFSET 32
-#define SUPPORTED_CHARS 96 // Number of characters in our font data (from ASCII 32 to 127)
-#define CAMERA_DISTANCE 25.0f
-#define TARGET_FPS 30 // Desired frames per second for the animation
 #define SCREEN_PADDING_FACTOR 0.85f // Use 85% of the smaller screen dimension for auto-zoom
+#define RESIZE_SETTLE_MS 50.0 // Apply a new terminal size once no resize arrived for this long
+#define BENCH_COLS 160 // Canvas size for headless benchmark runs
+#define BENCH_ROWS 48
+#define OBJECT_MAX_WORDS 64 // Words in one -O object specification
+#define DEG_TO_RAD (3.14159265f / 180.0f) // Timeline angles are in degrees
+#define DENSITY_CACHE_SLOTS 3       // Densities an object keeps its sampled geometry for (-q moves between them)
+#define DENSITY_MATCH_TOLERANCE 1e-3f // Relative; the same -q step reached up or down differs by rounding
+
+// Per-glyph effects (-E); rates are per frame
+#define EFFECT_WAVE_AMPLITUDE 0.25f // Of the character height
+#define EFFECT_WAVE_SPEED     0.15f // Radians
+#define EFFECT_WAVE_STEP      0.6f  // Radians between neighboring glyphs
+#define EFFECT_FLIP_FRAMES    24    // Frames one glyph takes to turn over
+#define EFFECT_FLIP_STAGGER   6     // Frames between neighboring glyphs starting their flip
+#define EFFECT_FLIP_PAUSE     45    // Frames all glyphs rest once the last one has flipped
+#define EFFECT_SPIN_SPEED     0.08f // Radians
+#define EFFECT_SPIN_PHASE     0.5f  // Radians between neighboring glyphs
+
+// Every option; a -O specification is parsed with the same string, then checked for per-object options
+#define HOLO_OPTIONS "s:a:b:r:A:w:h:z:t:?W:T:p:L:P:c:d:S:f:I:lGj:q:o:B:x:M:O:k:E:D:"
+
+
+// --- Usage ---
 
-
-// --- Globals for Signal Handling ---
-volatile int running = 1;
-volatile int terminal_resized = 1; // Start at 1 to trigger initial setup
-
-void handle_sigint(int sig) {
-    (void)sig; // Unused parameter
-    running = 0;
+void print_usage(const char* prog_name) {
+    fprintf(stderr, "Usage: %s [options] [TEXT TO DISPLAY...]\n", prog_name);
+    fprintf(stderr, "If no text is provided, the current date and time are displayed by default.\n\n");
+    fprintf(stderr, "Animation & Geometry:\n");
+    fprintf(stderr, " -a <val>   A-axis (pitch) speed. Default: %.2f\n", DEFAULT_SPEED_A);
+    fprintf(stderr, " -b <val>   B-axis (yaw) speed. Default: %.2f\n", DEFAULT_SPEED_B);
+    fprintf(stderr, " -r <val>   Roll speed, around the axis through the front of the text. Default: 0\n");
+    fprintf(stderr, " -A <x,y,z,speed> Also spin around the axis x,y,z of the text (no spaces). Default: none\n");
+    fprintf(stderr, " -s <val>   Set both speeds (a=val, b=val/2).\n");
+    fprintf(stderr, " -w <val>   Character width. Default: %.1f\n", DEFAULT_WIDTH);
+    fprintf(stderr, " -h <val>   Character height. Default: %.1f\n", DEFAULT_HEIGHT);
+    fprintf(stderr, " -S <val>   Character spacing multiplier. Default: %.2f\n", DEFAULT_SPACING_FACTOR);
+    fprintf(stderr, " -t <val>   Italic/tilt factor. Default: %.1f\n", DEFAULT_TILT);
+    fprintf(stderr, " -M <x,y,z> Position of the text's center in the scene (no spaces). Default: 0,0,0\n");
+    fprintf(stderr, " -E <name>  Move every character on its own: wave, flip (one after the other) or spin. Default: none\n");
+    fprintf(stderr, " -z <val>   Manual zoom, overrides auto-sizing.\n");
+    fprintf(stderr, " -I <val>   Render a full keyframe every <val> frames and warp the ones in between. Default: %d\n", DEFAULT_KEYFRAME_INTERVAL);
+    fprintf(stderr, "\nRendering & Appearance:\n");
+    fprintf(stderr, " -W <val>   Segment width (fatness). Default: %.1f\n", DEFAULT_SEG_WIDTH);
+    fprintf(stderr, " -T <val>   Segment thickness (depth). Default: %.1f\n", DEFAULT_SEG_THICK);
+    fprintf(stderr, " -p <val>   Pointy end length. Default: %.2f\n", DEFAULT_POINT_LEN);
+    fprintf(stderr, " -d <val>   Drawing density (step rate). Smaller is denser. Default: %.1f\n", DEFAULT_DENSITY);
+    fprintf(stderr, " -q <ms>    Adapt density to keep render time under <ms> per frame (-d is the finest).\n");
+    fprintf(stderr, " -l         Simplify glyph geometry as it gets smaller on screen (level of detail).\n");
+    fprintf(stderr, " -G         Sort points into %dx%d screen tiles and write the buffers one tile at a time.\n", TILE_W, TILE_H);
+    fprintf(stderr, " -j <n>     Render with <n> threads sharing per-glyph and per-tile jobs. Default: 1\n");
+    fprintf(stderr, " -L <x,y>   Light vector (no spaces). Default: %.1f,%.1f\n", DEFAULT_LIGHT_X, DEFAULT_LIGHT_Y);
+    fprintf(stderr, " -c <val>   Shading contrast. Default: %.1f\n", DEFAULT_CONTRAST);
+    fprintf(stderr, " -P <str>   Shading character palette. Default: \"%s\"\n", DEFAULT_ASCII_PALETTE);
+    fprintf(stderr, " -o <val>   Limit terminal output to <val> bytes per second, dropping frames as needed.\n");
+    fprintf(stderr, " -f <fmt>   Set the date/time format (strftime). Default: \"%s\"\n", DEFAULT_TIME_FORMAT);
+    fprintf(stderr, "            Examples: \"%%Y-%%m-%%d\" (date), \"%%I:%%M %%p\" (12h), \"%%Y-%%m-%%d %%H:%%M\" (both)\n");
+    fprintf(stderr, " -D <style>[,frames] Change characters segment by segment: fade, grow or flip. Default frames: %d\n", DEFAULT_TRANSITION_FRAMES);
+    fprintf(stderr, "\nScene:\n");
+    fprintf(stderr, " -O <spec>  Add a text object (up to %d in all). <spec> holds its own options, then its text:\n", SCENE_MAX_OBJECTS);
+    fprintf(stderr, "            -a -b -r -A -s -w -h -S -t -M -E -W -T -p -c -P -f -D, separated by spaces.\n");
+    fprintf(stderr, "            Example: -O \"-M 0,-10,0 -h 5 -w 3 -a 0 NEWS\". The other options apply to the whole scene.\n");
+    fprintf(stderr, " -k <file>  Animate pitch, yaw, roll, tilt, zoom, light and text from a timeline file:\n");
+    fprintf(stderr, "            lines of \"<seconds> <property> <value> [linear|ease-in|ease-out|ease-in-out|step]\",\n");
+    fprintf(stderr, "            plus \"object <n>\" to pick the object animated next and \"loop <seconds>\".\n");
+    fprintf(stderr, "\nExport:\n");
+    fprintf(stderr, " -x <file>  Write the text's geometry as a mesh (.stl for STL, otherwise OBJ) and exit.\n");
+    fprintf(stderr, "\nBenchmarking:\n");
+    fprintf(stderr, " -B <n>     Render <n> frames headless on a %dx%d canvas as fast as possible and report frames/s.\n", BENCH_COLS, BENCH_ROWS);
+    fprintf(stderr, "\n -?         Display this help message.\n");
 }
 
-void handle_sigwinch(int sig) {
-    (void)sig; // Unused parameter
-    terminal_resized = 1;
-}
 
+// --- Text Objects ---
 
-// --- Platform-Specific Terminal Size Detection ---
-#ifdef _WIN32
-void get_terminal_size(int* width, int* height) {
-    CONSOLE_SCREEN_BUFFER_INFO csbi;
-    GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi);
-    *width = csbi.srWindow.Right - csbi.srWindow.Left + 1;
-    *height = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
-}
-#else
-#include <sys/ioctl.h>
-void get_terminal_size(int* width, int* height) {
-    struct winsize w;
-    ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
-    *width = w.ws_col;
-    *height = w.ws_row;
-}
-#endif
+/**
+ * @brief Motion of every glyph around its place in the text (-E).
+ */
+typedef enum {
+    EFFECT_NONE,
+    EFFECT_WAVE, // Glyphs bob up and down, one after the other
+    EFFECT_FLIP, // Glyphs turn over around their horizontal axis, one after the other
+    EFFECT_SPIN  // Glyphs turn around their vertical axis, out of phase
+} GlyphEffect;
 
+/**
+ * @brief How the segments of a changing character leave and arrive (-D).
+ */
+typedef enum {
+    TRANSITION_NONE, // The new character replaces the old one at once
+    TRANSITION_FADE, // Old segments darken away while new ones brighten
+    TRANSITION_GROW, // Old segments shrink away while new ones grow
+    TRANSITION_FLIP  // Old segments turn edge-on, then new ones turn face-on
+} TransitionStyle;
 
-// --- Data Structures ---
+/**
+ * @brief An object's geometry sampled at one density.
+ */
+typedef struct {
+    SegmentTemplates templates; // Sampled segment surfaces
+    GlyphCache glyph_cache;     // Glyphs merged from the templates, compiled as they appear
+    unsigned last_used;         // Full render that last used it, for replacing the oldest
+} DensityGeometry;
 
 /**
- * @brief Holds all necessary state for rendering a single frame.
- * This includes screen buffers, dimensions, pre-calculated animation values,
- * and configuration for geometry, projection, and lighting. Bundling this
- * state prevents passing a dozen arguments to every rendering function.
+ * @brief One text of the scene, with its own options, geometry and animation state.
+ * The options and words of the command line make object 0; every -O adds one.
+ * All objects are drawn into the same buffers, so they hide each other.
  */
 typedef struct {
-    // Buffers and screen dimensions
-    float* zbuffer;
-    char*  bbuffer;
-    int    sw, sh;
+    // Options
+    float speedA, speedB, speedC, W, H, tilt, spacing_factor;
+    float axis_x, axis_y, axis_z, axis_speed; // Extra spin around an arbitrary axis (-A)
+    float seg_w, seg_t, point_len, contrast;
+    float pos_x, pos_y, pos_z; // Position of the text's center (-M)
+    GlyphEffect effect;
+    const char* palette;
+    const char* time_date_format;
+    TransitionStyle transition;
+    int transition_frames;
 
-    // Pre-calculated animation state for the current frame
-    float cosA, sinA, cosB, sinB;
+    // Text: the given words, or the current date and time when there are none
+    int show_time_date;
+    const char* text_to_display;
+    char time_buffer[64];      // Buffer for date/time string, large enough for custom formats
+    char last_time_buffer[64];
+    const char* last_text;     // Text of the previous frame, to notice a timeline switching texts
+    int text_len;
+    size_t max_text_len;       // Longest text we may have to draw, for sizing the per-glyph state
+    char* combined_args;       // The words joined with spaces
+    char* spec_words;          // The -O specification, split into words; options point into it
+    char* shown_text;          // With -D: the text drawn last frame
+    char* transition_from;     // With -D: the text the current transition started from
+    int transition_end;        // Frame at which the current transition is over
+
+    // Geometry, computed once from the options
+    SegmentDef seg_defs[NUM_SEGMENTS];
+    float segment_lengths[NUM_SEGMENTS];
+    float char_spacing;
+    size_t palette_len;
 
-    // Configuration for geometry and projection
-    float zoom;
-    float tilt_factor;
+    // Rendering state
+    float A, B, C; // Pitch, yaw and roll angles
+    float spin;    // Angle around the -A axis
+    int* glyph_lods;            // Per-glyph level of detail, kept across frames for hysteresis
+    DensityGeometry geometry[DENSITY_CACHE_SLOTS]; // The densities used lately, built on the first full render
+    unsigned geometry_clock;                       // Full renders so far, for DensityGeometry.last_used
+    const GlyphCache* glyph_cache;                 // The glyphs of the current density
+} TextObject;
+
+static const TextObject default_object = {
+    .speedA = DEFAULT_SPEED_A, .speedB = DEFAULT_SPEED_B, .W = DEFAULT_WIDTH, .H = DEFAULT_HEIGHT,
+    .tilt = DEFAULT_TILT, .spacing_factor = DEFAULT_SPACING_FACTOR,
+    .seg_w = DEFAULT_SEG_WIDTH, .seg_t = DEFAULT_SEG_THICK, .point_len = DEFAULT_POINT_LEN,
+    .contrast = DEFAULT_CONTRAST,
+    .palette = DEFAULT_ASCII_PALETTE, .time_date_format = DEFAULT_TIME_FORMAT,
+    .transition_frames = DEFAULT_TRANSITION_FRAMES
+};
 
-    // Configuration for lighting and appearance
-    float light_x, light_y, contrast;
-    const char* palette;
-    size_t palette_len;
-} RenderContext;
+/**
+ * @brief Applies an option that belongs to a single text object.
+ * @return 1 if it was applied, 0 if `opt` is not a per-object option, -1 if its value is invalid.
+ */
+static int parse_object_option(TextObject* obj, int opt, const char* arg) {
+    switch (opt) {
+        case 's': obj->speedA = atof(arg); obj->speedB = atof(arg) / 2.0f; return 1;
+        case 'a': obj->speedA = atof(arg); return 1;
+        case 'b': obj->speedB = atof(arg); return 1;
+        case 'r': obj->speedC = atof(arg); return 1;
+        case 'A': if (sscanf(arg, "%f,%f,%f,%f", &obj->axis_x, &obj->axis_y, &obj->axis_z, &obj->axis_speed) != 4) { fprintf(stderr, "Invalid spin axis. Use x,y,z,speed\n"); return -1; } return 1;
+        case 'w': obj->W = atof(arg); return 1;
+        case 'h': obj->H = atof(arg); return 1;
+        case 't': obj->tilt = atof(arg); return 1;
+        case 'W': obj->seg_w = atof(arg); return 1;
+        case 'T': obj->seg_t = atof(arg); return 1;
+        case 'p': obj->point_len = atof(arg); return 1;
+        case 'P': obj->palette = arg; return 1;
+        case 'c': obj->contrast = atof(arg); return 1;
+        case 'S': obj->spacing_factor = atof(arg); return 1;
+        case 'f': obj->time_date_format = arg; return 1;
+        case 'M': if (sscanf(arg, "%f,%f,%f", &obj->pos_x, &obj->pos_y, &obj->pos_z) != 3) { fprintf(stderr, "Invalid position. Use x,y,z\n"); return -1; } return 1;
+        case 'E':
+            if (strcmp(arg, "wave") == 0) obj->effect = EFFECT_WAVE;
+            else if (strcmp(arg, "flip") == 0) obj->effect = EFFECT_FLIP;
+            else if (strcmp(arg, "spin") == 0) obj->effect = EFFECT_SPIN;
+            else if (strcmp(arg, "none") == 0) obj->effect = EFFECT_NONE;
+            else { fprintf(stderr, "Invalid effect. Use wave, flip, spin or none\n"); return -1; }
+            return 1;
+        case 'D': {
+            char name[8];
+            obj->transition_frames = DEFAULT_TRANSITION_FRAMES;
+            int fields = sscanf(arg, "%7[a-z],%d", name, &obj->transition_frames);
+            if (fields < 1 || obj->transition_frames < 1) { fprintf(stderr, "Invalid transition. Use fade, grow, flip or none, then optionally ,frames\n"); return -1; }
+            if (strcmp(name, "fade") == 0) obj->transition = TRANSITION_FADE;
+            else if (strcmp(name, "grow") == 0) obj->transition = TRANSITION_GROW;
+            else if (strcmp(name, "flip") == 0) obj->transition = TRANSITION_FLIP;
+            else if (strcmp(name, "none") == 0) obj->transition = TRANSITION_NONE;
+            else { fprintf(stderr, "Invalid transition. Use fade, grow, flip or none, then optionally ,frames\n"); return -1; }
+            return 1;
+        }
+        default: return 0;
+    }
+}
 
 /**
- * @brief Defines a single segment's position and orientation.
- * Pre-calculating the rotation sine and cosine saves computation in the render loop.
+ * @brief Sets the object's text from its words, or to the date and time when there are none,
+ * and lays out its font.
+ * @return 1 on success, 0 if the memory could not be allocated.
  */
-typedef struct {
-    float pos_x, pos_y;
-    float rot_z_rad;
-    float cos_ra, sin_ra; // Pre-calculated cos and sin of rot_z_rad
-} SegmentDef;
+static int text_object_setup(TextObject* obj, char* const* words, int count) {
+    obj->show_time_date = (count <= 0);
+    if (obj->show_time_date) {
+        obj->text_to_display = obj->time_buffer;
+        obj->max_text_len = sizeof(obj->time_buffer);
+    } else {
+        size_t total_len = 0;
+        for (int i = 0; i < count; i++) total_len += strlen(words[i]) + 1;
+        if (!(obj->combined_args = malloc(total_len))) { fprintf(stderr, "Memory allocation failed\n"); return 0; }
+        char* current_pos = obj->combined_args;
+        for (int i = 0; i < count; i++) {
+            strcpy(current_pos, words[i]);
+            current_pos += strlen(words[i]);
+            if (i < count - 1) *current_pos++ = ' ';
+        }
+        *current_pos = '\0';
+        obj->text_to_display = obj->combined_args;
+        obj->max_text_len = strlen(obj->text_to_display);
+    }
+    obj->palette_len = strlen(obj->palette);
 
+    // --- Pre-calculate Object-Level Geometry (do this once!) ---
+    font_layout(obj->W, obj->H, obj->seg_w, obj->seg_defs, obj->segment_lengths);
+    obj->char_spacing = obj->W * obj->spacing_factor;
+    return 1;
+}
 
-// --- Core Rendering Functions ---
+/**
+ * @brief Makes the next getopt call scan a new argument vector from the start.
+ */
+static void restart_getopt(void) {
+#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+    optreset = 1;
+    optind = 1;
+#else
+    optind = 0; // glibc, musl and MinGW reinitialize their scan state
+#endif
+}
 
 /**
- * @brief Projects a 3D point onto the 2D screen buffer.
- * Handles Z-buffering, lighting, and character selection from the palette.
- * @param x, y, z The coordinates of the point in character-local space.
- * @param nx, ny, nz The components of the surface normal vector for lighting.
- * @param ctx The RenderContext containing all state for the current frame.
+ * @brief Reads a -O specification: per-object options, then the object's text.
+ * The specification is split on whitespace and goes through getopt like the
+ * command line, so options are written the same way in both places.
+ * @return 1 on success, 0 on an invalid specification or a failed allocation.
  */
-void project_and_draw(float x, float y, float z, float nx, float ny, float nz,
-                      const RenderContext* ctx) {
-    // Apply shear transformation for an italic/tilted effect
-    x += y * ctx->tilt_factor;
-
-    // Rotate around Y axis (B - yaw)
-    float rot_x = x * ctx->cosB - z * ctx->sinB;
-    float rot_z = x * ctx->sinB + z * ctx->cosB;
-
-    // Rotate around X axis (A - pitch) and translate forward
-    float final_y = y * ctx->cosA - rot_z * ctx->sinA;
-    float final_z = y * ctx->sinA + rot_z * ctx->cosA + CAMERA_DISTANCE;
-
-    // Don't render points behind the camera
-    if (final_z <= 0) return;
-
-    // Perspective projection
-    float ooz = 1.0f / final_z; // one over z
-    // Stretch horizontally to compensate for non-square terminal characters
-    int xp = (int)(ctx->sw / 2.0f + (ctx->zoom * 2.0f) * rot_x * ooz);
-    int yp = (int)(ctx->sh / 2.0f - ctx->zoom * final_y * ooz);
-
-    // Bounds and Z-buffer check
-    int buffer_idx = xp + ctx->sw * yp;
-    if (xp < 0 || xp >= ctx->sw || yp < 0 || yp >= ctx->sh || ooz <= ctx->zbuffer[buffer_idx]) {
-        return;
+static int parse_object_spec(TextObject* obj, const char* spec, char* prog_name) {
+    char* words[OBJECT_MAX_WORDS + 2];
+    int count = 0;
+    if (!(obj->spec_words = malloc(strlen(spec) + 1))) { fprintf(stderr, "Memory allocation failed\n"); return 0; }
+    strcpy(obj->spec_words, spec);
+    words[count++] = prog_name;
+    for (char* word = strtok(obj->spec_words, " \t\n"); word; word = strtok(NULL, " \t\n")) {
+        if (count == OBJECT_MAX_WORDS + 1) { fprintf(stderr, "Too many words in object \"%s\"\n", spec); return 0; }
+        words[count++] = word;
     }
+    words[count] = NULL;
 
-    // Rotate the normal vector to match the world orientation for lighting calculation
-    float n_rot_x = nx * ctx->cosB - nz * ctx->sinB;
-    float n_rot_z = nx * ctx->sinB + nz * ctx->cosB;
-    float n_final_y = ny * ctx->cosA - n_rot_z * ctx->sinA;
+    restart_getopt();
+    int opt;
+    while ((opt = getopt(count, words, HOLO_OPTIONS)) != -1) {
+        int applied = parse_object_option(obj, opt, optarg);
+        if (applied < 0) return 0;
+        if (applied == 0) {
+            if (opt == '?') fprintf(stderr, "Invalid object \"%s\"\n", spec);
+            else fprintf(stderr, "-%c applies to the whole scene, not to object \"%s\"\n", opt, spec);
+            return 0;
+        }
+    }
+    return text_object_setup(obj, words + optind, count - optind);
+}
 
-    // Simple dot product for luminance
-    float L = n_final_y * ctx->light_y + n_rot_x * ctx->light_x;
+/**
+ * @brief Brings the object's segment templates and compiled glyphs up to date for a full render.
+ * The geometry of the last few densities is kept, so when the quality
+ * controller goes back to a density nothing is resampled or recompiled.
+ * @return 1 on success, 0 if the memory could not be allocated.
+ */
+static int text_object_prepare(TextObject* obj, float density, int num_lods) {
+    // The slot holding this density, or else the one used longest ago
+    DensityGeometry* slot = &obj->geometry[0];
+    for (int i = 0; i < DENSITY_CACHE_SLOTS; i++) {
+        DensityGeometry* g = &obj->geometry[i];
+        if (fabsf(g->templates.density - density) <= density * DENSITY_MATCH_TOLERANCE) {
+            slot = g;
+            break;
+        }
+        if (g->last_used < slot->last_used) slot = g;
+    }
+    slot->last_used = ++obj->geometry_clock;
+
+    // Resample the segment templates for a density the object has not kept
+    if (fabsf(slot->templates.density - density) > density * DENSITY_MATCH_TOLERANCE &&
+        !segment_templates_build(&slot->templates, obj->segment_lengths, obj->seg_w, obj->seg_t, obj->point_len,
+                                 density, num_lods)) {
+        fprintf(stderr, "Template allocation failed. Exiting.\n");
+        return 0;
+    }
+    if (!glyph_cache_prepare(&slot->glyph_cache, &slot->templates, obj->seg_defs, obj->text_to_display)) {
+        fprintf(stderr, "Glyph cache allocation failed. Exiting.\n");
+        return 0;
+    }
+    if (obj->transition && !glyph_cache_prepare_segments(&slot->glyph_cache, &slot->templates, obj->seg_defs)) {
+        fprintf(stderr, "Glyph cache allocation failed. Exiting.\n");
+        return 0;
+    }
+    obj->glyph_cache = &slot->glyph_cache;
+    return 1;
+}
 
-    // Update buffers
-    ctx->zbuffer[buffer_idx] = ooz;
-    int palette_idx = (int)(L * ctx->contrast);
-    palette_idx = palette_idx < 0 ? 0 : (palette_idx >= ctx->palette_len ? ctx->palette_len - 1 : palette_idx); // Clamp
-    ctx->bbuffer[buffer_idx] = ctx->palette[palette_idx];
+/**
+ * @brief The object's orientation for its current angles.
+ * Roll and the -A spin turn the text in its own space; yaw and pitch then
+ * turn the result, as they always have.
+ */
+static Quaternion text_object_orientation(const TextObject* obj) {
+    Quaternion q = quat_axis_angle(1.0f, 0.0f, 0.0f, obj->A);              // Pitch
+    q = quat_mul(q, quat_axis_angle(0.0f, 1.0f, 0.0f, -obj->B));           // Yaw (B turns +X toward +Z)
+    q = quat_mul(q, quat_axis_angle(0.0f, 0.0f, 1.0f, obj->C));            // Roll
+    return quat_mul(q, quat_axis_angle(obj->axis_x, obj->axis_y, obj->axis_z, obj->spin));
 }
 
+/**
+ * @brief Frames glyph `index` of a flipping object is into its current turn.
+ * Each glyph turns once per cycle, EFFECT_FLIP_STAGGER frames after its left
+ * neighbor; values of EFFECT_FLIP_FRAMES and over mean it is resting.
+ */
+static int flip_phase(const TextObject* obj, int index, int frame) {
+    int cycle = obj->text_len * EFFECT_FLIP_STAGGER + EFFECT_FLIP_FRAMES + EFFECT_FLIP_PAUSE;
+    int phase = (frame - index * EFFECT_FLIP_STAGGER) % cycle;
+    return phase < 0 ? phase + cycle : phase;
+}
 
 /**
- * @brief Helper to rotate a point/normal from segment-local space to character space.
- * This reduces code duplication within draw_pointy_segment.
- * @param px, py, pz Point coordinates relative to the segment's center.
- * @param nx, ny, nz Normal vector components.
- * @param def The segment's definition (position and pre-calculated rotation).
- * @param char_center_x The X-offset of the character this segment belongs to.
- * @param ctx The RenderContext for the current frame.
+ * @brief Whether any glyph of the object moves on its own (-E) in the given frame.
+ * Warping a keyframe only follows the object's transform, so such frames must be rendered in full.
  */
-static void draw_rotated_point(
-    float px, float py, float pz,      // Point coords relative to segment center
-    float nx, float ny, float nz,      // Normal vector
-    const SegmentDef* def, float char_center_x, // Segment and character definitions
-    const RenderContext* ctx
-) {
-    // Rotate segment points and normals into character-local orientation
-    float rpx = px * def->cos_ra - py * def->sin_ra;
-    float rpy = px * def->sin_ra + py * def->cos_ra;
-    float rnx = nx * def->cos_ra - ny * def->sin_ra;
-    float rny = nx * def->sin_ra + ny * def->cos_ra;
-    // Rotation is around the Z-axis, so the normal's Z component is unchanged
-    float rnz = nz;
-
-    // Translate to final position and project
-    project_and_draw(rpx + def->pos_x + char_center_x, rpy + def->pos_y, pz,
-                     rnx, rny, rnz, ctx);
+static int effect_in_motion(const TextObject* obj, int frame) {
+    switch (obj->effect) {
+        case EFFECT_WAVE:
+        case EFFECT_SPIN:
+            return 1;
+        case EFFECT_FLIP:
+            for (int i = 0; i < obj->text_len; i++) {
+                if (flip_phase(obj, i, frame) < EFFECT_FLIP_FRAMES) return 1;
+            }
+            return 0;
+        case EFFECT_NONE:
+        default:
+            return 0;
+    }
 }
 
 /**
- * @brief Draws a single 3D segment with flat faces and pointy ends.
- * This function iterates over the surface of the segment, calling the projection
- * function for each point.
+ * @brief Places glyph `index` of the object for the given frame, with its -E motion.
+ * The effect only changes the glyph's matrix, so the cached geometry is drawn
+ * as it is and a moving glyph costs the same as a still one.
  */
-void draw_pointy_segment(float length, float seg_w, float seg_t, float point_len,
-                         const SegmentDef* def, float char_center_x, float density,
-                         const RenderContext* ctx)
+static void place_glyph(const TextObject* obj, const RenderContext* ctx, int index, float char_center_x, int frame,
+                        GlyphTransform* xf)
 {
-    // Draw the top and bottom flat faces of the segment
-    for (float i = -length / 2.0f; i < length / 2.0f; i += density) {
-        for (float j = -seg_t / 2.0f; j < seg_t / 2.0f; j += density) {
-            // Top face (normal points up in local Y)
-            draw_rotated_point(i, seg_w / 2.0f, j, 0, 1, 0, def, char_center_x, ctx);
-            // Bottom face (normal points down in local Y)
-            draw_rotated_point(i, -seg_w / 2.0f, j, 0, -1, 0, def, char_center_x, ctx);
+    float local[3][3];
+    float angle;
+    switch (obj->effect) {
+        case EFFECT_WAVE:
+            glyph_transform(ctx, NULL, char_center_x,
+                            EFFECT_WAVE_AMPLITUDE * obj->H * sinf(frame * EFFECT_WAVE_SPEED - index * EFFECT_WAVE_STEP), 0.0f, xf);
+            return;
+        case EFFECT_FLIP: {
+            int phase = flip_phase(obj, index, frame);
+            if (phase >= EFFECT_FLIP_FRAMES) break;
+            float u = phase / (float)EFFECT_FLIP_FRAMES;
+            angle = 2.0f * 3.14159265f * u * u * (3.0f - 2.0f * u); // Eased in and out
+            quat_to_matrix(quat_axis_angle(1.0f, 0.0f, 0.0f, angle), local);
+            glyph_transform(ctx, local, char_center_x, 0.0f, 0.0f, xf);
+            return;
         }
+        case EFFECT_SPIN:
+            angle = frame * EFFECT_SPIN_SPEED + index * EFFECT_SPIN_PHASE;
+            quat_to_matrix(quat_axis_angle(0.0f, 1.0f, 0.0f, angle), local);
+            glyph_transform(ctx, local, char_center_x, 0.0f, 0.0f, xf);
+            return;
+        case EFFECT_NONE:
+        default:
+            break;
     }
+    glyph_transform(ctx, NULL, char_center_x, 0.0f, 0.0f, xf);
+}
 
-    // Draw the front and back faces of the segment body
-    for (float i = -length / 2.0f; i < length / 2.0f; i += density) {
-        for (float j = -seg_w / 2.0f; j < seg_w / 2.0f; j += density) {
-            // Front face (normal points out in local +Z)
-            draw_rotated_point(i, j, seg_t / 2.0f, 0, 0, 1, def, char_center_x, ctx);
-            // Back face (normal points in in local -Z)
-            draw_rotated_point(i, j, -seg_t / 2.0f, 0, 0, -1, def, char_center_x, ctx);
+/**
+ * @brief Splits a changing glyph into its segments, each placed for the transition (-D).
+ * Segments of both the old and the new character stay where they are; the
+ * ones only the old character has leave, and the ones only the new one has
+ * arrive. Only changing glyphs are drawn this way, from the glyph cache's
+ * separate segments, so the other glyphs cost what they always did.
+ * @param u Progress of the transition, from 0 (the old character) to 1 (the new one).
+ * @param[out] pieces, placements The segments to draw and where.
+ * @return The number of pieces, at most NUM_SEGMENTS.
+ */
+static int transition_pieces(const TextObject* obj, char from, char to, float u, int lod, const GlyphTransform* xf,
+                             const GlyphPoints** pieces, GlyphTransform* placements)
+{
+    const uint16_t changed = FourteenSegmentASCII[from - ASCII_OFFSET] ^ FourteenSegmentASCII[to - ASCII_OFFSET];
+    const uint16_t to_segments = FourteenSegmentASCII[to - ASCII_OFFSET];
+    const uint16_t segments = FourteenSegmentASCII[from - ASCII_OFFSET] | to_segments;
+    u = u * u * (3.0f - 2.0f * u); // Eased in and out
+    int count = 0;
+    for (int i = 0; i < NUM_SEGMENTS; i++) {
+        if (!((segments >> i) & 1)) continue;
+        const SegmentDef* def = &obj->seg_defs[i];
+        GlyphTransform* out = &placements[count];
+        if (!((changed >> i) & 1)) {
+            *out = *xf;
+        } else {
+            const int arriving = (to_segments >> i) & 1;
+            const float shown = arriving ? u : 1.0f - u; // How much of the segment is there
+            if (obj->transition == TRANSITION_FLIP) {
+                // Leaving segments turn edge-on in the first half, arriving ones turn back in the second
+                float turn = arriving ? 2.0f * (1.0f - u) : 2.0f * u;
+                if (turn >= 1.0f) continue;
+                float local[3][3];
+                quat_to_matrix(quat_axis_angle(def->cos_ra, def->sin_ra, 0.0f, turn * 3.14159265f / 2.0f), local);
+                segment_transform(xf, local, 1.0f, def->pos_x, def->pos_y, out);
+            } else if (shown <= 0.0f) {
+                continue;
+            } else if (obj->transition == TRANSITION_GROW) {
+                segment_transform(xf, NULL, shown, def->pos_x, def->pos_y, out);
+            } else {
+                // Fading: a dimmer light picks darker palette characters
+                *out = *xf;
+                for (int k = 0; k < 3; k++) out->light[k] *= shown;
+            }
         }
+        pieces[count++] = &obj->glyph_cache->segments[i][lod];
     }
+    return count;
+}
 
-    // Draw the four triangular faces of the pointy ends
-    const float half_w = seg_w / 2.0f;
-    float nl = sqrtf(half_w * half_w + point_len * point_len); // Normal vector length
-    if (nl < 1e-5) return; // Avoid division by zero
-    float cnx = half_w / nl;  // Normal X component for the slope
-    float cny = point_len / nl; // Normal Y component for the slope
-
-    for (float u = 0; u < point_len; u += density) {
-        for (float pz = -seg_t / 2.0f; pz < seg_t / 2.0f; pz += density) {
-            float yp = half_w * (1.0f - u / point_len); // Y-position on the triangle slope
-            float p1 = length / 2.0f + u;
-            float p2 = -length / 2.0f - u;
-
-            // End 1, Top Face
-            draw_rotated_point(p1, yp, pz, cnx, cny, 0, def, char_center_x, ctx);
-            // End 1, Bottom Face
-            draw_rotated_point(p1, -yp, pz, cnx, -cny, 0, def, char_center_x, ctx);
-            // End 2, Top Face
-            draw_rotated_point(p2, yp, pz, -cnx, cny, 0, def, char_center_x, ctx);
-            // End 2, Bottom Face
-            draw_rotated_point(p2, -yp, pz, -cnx, -cny, 0, def, char_center_x, ctx);
+/**
+ * @brief Sets every property the timeline animates to its value at `t` seconds.
+ * Animated angles replace the ones the speeds advance; the others keep moving.
+ * @param[out] zoom The animated zoom, left alone if the zoom is not animated.
+ */
+static void apply_timeline(const Timeline* timeline, float t, TextObject* objects, int num_objects,
+                           float* zoom, float* light_x, float* light_y)
+{
+    float value[2];
+    const char* text;
+    for (int o = 0; o < num_objects; o++) {
+        TextObject* obj = &objects[o];
+        if (timeline_sample(timeline, o, TRACK_PITCH, t, value, NULL)) obj->A = value[0] * DEG_TO_RAD;
+        if (timeline_sample(timeline, o, TRACK_YAW, t, value, NULL)) obj->B = value[0] * DEG_TO_RAD;
+        if (timeline_sample(timeline, o, TRACK_ROLL, t, value, NULL)) obj->C = value[0] * DEG_TO_RAD;
+        if (timeline_sample(timeline, o, TRACK_TILT, t, value, NULL)) obj->tilt = value[0];
+        if (timeline_sample(timeline, o, TRACK_TEXT, t, value, &text)) {
+            obj->show_time_date = (text == NULL);
+            obj->text_to_display = text ? text : obj->time_buffer;
         }
     }
+    if (timeline_sample(timeline, 0, TRACK_ZOOM, t, value, NULL)) *zoom = value[0];
+    if (timeline_sample(timeline, 0, TRACK_LIGHT, t, value, NULL)) {
+        *light_x = value[0];
+        *light_y = value[1];
+    }
 }
 
-
-// --- Font Data & Usage ---
-
-// Segments are bit-packed: 0=A, 1=B, 2=C, 3=D, 4=E, 5=F, 6=G1, 7=G2, 8=H, 9=I, 10=J, 11=K, 12=L, 13=M
-const uint16_t FourteenSegmentASCII[SUPPORTED_CHARS] = {
-    0b00000000000000, 0b10000000000110, 0b00001000000010, 0b01001011001110, 0b01001011101101, 0b11111111100100, 0b10001101011001, 0b00001000000000,
-    0b10010000000000, 0b00100100000000, 0b11111111000000, 0b01001011000000, 0b00100000000000, 0b00000011000000, 0b10000000000000, 0b00110000000000,
-    0b00110000111111, 0b00010000000110, 0b00000011011011, 0b00000010001111, 0b00000011100110, 0b10000001101001, 0b00000011111101, 0b00000000000111,
-    0b00000011111111, 0b00000011101111, 0b01001000000000, 0b00101000000000, 0b10010001000000, 0b00000011001000, 0b00100110000000, 0b11000010000011,
-    0b00001010111011, 0b00000011110111, 0b01001010001111, 0b00000000111001, 0b01001000001111, 0b00000001111001, 0b00000001110001, 0b00000010111101,
-    0b00000011110110, 0b01001000001001, 0b00000000011110, 0b10010001110000, 0b00000000111000, 0b00010100110110, 0b10000100110110, 0b00000000111111,
-    0b00000011110011, 0b10000000111111, 0b10000011110011, 0b00000011101101, 0b01001000000001, 0b00000000111110, 0b00110000110000, 0b10100000110110,
-    0b10110100000000, 0b00000011101110, 0b00110000001001, 0b00000000111001, 0b10000100000000, 0b00000000001111, 0b10100000000000, 0b00000000001000,
-    0b00000100000000, 0b01000001011000, 0b10000001111000, 0b00000011011000, 0b00100010001110, 0b00100001011000, 0b01010011000000, 0b00010010001110,
-    0b01000001110000, 0b01000000000000, 0b00101000010000, 0b11011000000000, 0b00000000110000, 0b01000011010100, 0b01000001010000, 0b00000011011100,
-    0b00000101110000, 0b00010010000110, 0b00000001010000, 0b10000010001000, 0b00000001111000, 0b00000000011100, 0b00100000010000, 0b10100000010100,
-    0b10110100000000, 0b00001010001110, 0b00100001001000, 0b00100101001001, 0b01001000000000, 0b10010010001001, 0b00110011000000, 0b00000000000000
-};
-
-void print_usage(const char* prog_name) {
-    fprintf(stderr, "Usage: %s [options] [TEXT TO DISPLAY...]\n", prog_name);
-    fprintf(stderr, "If no text is provided, the current date and time are displayed by default.\n\n");
-    fprintf(stderr, "Animation & Geometry:\n");
-    fprintf(stderr, " -a <val>   A-axis (pitch) speed. Default: %.2f\n", DEFAULT_SPEED_A);
-    fprintf(stderr, " -b <val>   B-axis (yaw) speed. Default: %.2f\n", DEFAULT_SPEED_B);
-    fprintf(stderr, " -s <val>   Set both speeds (a=val, b=val/2).\n");
-    fprintf(stderr, " -w <val>   Character width. Default: %.1f\n", DEFAULT_WIDTH);
-    fprintf(stderr, " -h <val>   Character height. Default: %.1f\n", DEFAULT_HEIGHT);
-    fprintf(stderr, " -S <val>   Character spacing multiplier. Default: %.2f\n", DEFAULT_SPACING_FACTOR);
-    fprintf(stderr, " -t <val>   Italic/tilt factor. Default: %.1f\n", DEFAULT_TILT);
-    fprintf(stderr, " -z <val>   Manual zoom, overrides auto-sizing.\n");
-    fprintf(stderr, "\nRendering & Appearance:\n");
-    fprintf(stderr, " -W <val>   Segment width (fatness). Default: %.1f\n", DEFAULT_SEG_WIDTH);
-    fprintf(stderr, " -T <val>   Segment thickness (depth). Default: %.1f\n", DEFAULT_SEG_THICK);
-    fprintf(stderr, " -p <val>   Pointy end length. Default: %.2f\n", DEFAULT_POINT_LEN);
-    fprintf(stderr, " -d <val>   Drawing density (step rate). Smaller is denser. Default: %.1f\n", DEFAULT_DENSITY);
-    fprintf(stderr, " -L <x,y>   Light vector (no spaces). Default: %.1f,%.1f\n", DEFAULT_LIGHT_X, DEFAULT_LIGHT_Y);
-    fprintf(stderr, " -c <val>   Shading contrast. Default: %.1f\n", DEFAULT_CONTRAST);
-    fprintf(stderr, " -P <str>   Shading character palette. Default: \"%s\"\n", DEFAULT_ASCII_PALETTE);
-    fprintf(stderr, " -f <fmt>   Set the date/time format (strftime). Default: \"%s\"\n", DEFAULT_TIME_FORMAT);
-    fprintf(stderr, "            Examples: \"%%Y-%%m-%%d\" (date), \"%%I:%%M %%p\" (12h), \"%%Y-%%m-%%d %%H:%%M\" (both)\n");
-    fprintf(stderr, "\n -?         Display this help message.\n");
+static void free_objects(TextObject* objects, int num_objects) {
+    for (int o = 0; o < num_objects; o++) {
+        for (int i = 0; i < DENSITY_CACHE_SLOTS; i++) {
+            segment_templates_free(&objects[o].geometry[i].templates);
+            glyph_cache_free(&objects[o].geometry[i].glyph_cache);
+        }
+        free(objects[o].combined_args);
+        free(objects[o].spec_words);
+        free(objects[o].shown_text);
+    }
 }
 
 
@@ -330,234 +554,463 @@ void print_usage(const char* prog_name) {
 
 int main(int argc, char* argv[]) {
     // --- Configuration Variables ---
-    float speedA = DEFAULT_SPEED_A, speedB = DEFAULT_SPEED_B, W = DEFAULT_WIDTH, H = DEFAULT_HEIGHT, tilt = DEFAULT_TILT;
-    float spacing_factor = DEFAULT_SPACING_FACTOR;
-    float seg_w = DEFAULT_SEG_WIDTH, seg_t = DEFAULT_SEG_THICK, point_len = DEFAULT_POINT_LEN;
-    float light_x = DEFAULT_LIGHT_X, light_y = DEFAULT_LIGHT_Y, contrast = DEFAULT_CONTRAST, density = DEFAULT_DENSITY;
-    const char* palette = DEFAULT_ASCII_PALETTE;
-    const char* time_date_format = DEFAULT_TIME_FORMAT;
+    // Options of a single text live in its TextObject; these apply to the whole scene
+    TextObject objects[SCENE_MAX_OBJECTS];
+    const char* object_specs[SCENE_MAX_OBJECTS];
+    int num_objects = 1;
+    float light_x = DEFAULT_LIGHT_X, light_y = DEFAULT_LIGHT_Y, density = DEFAULT_DENSITY;
     float manual_zoom = -1.0f;
+    int keyframe_interval = DEFAULT_KEYFRAME_INTERVAL;
+    int use_lod = 0;
+    int use_tiles = 0;
+    int num_threads = 1;
+    float frame_budget_ms = 0;
+    double output_rate_limit = 0;
+    int bench_frames = 0;
+    const char* export_path = NULL;
+    const char* timeline_path = NULL;
+    for (int o = 0; o < SCENE_MAX_OBJECTS; o++) objects[o] = default_object;
 
     // --- Argument Parsing ---
     int opt;
-    while ((opt = getopt(argc, argv, "s:a:b:w:h:z:t:?W:T:p:L:P:c:d:S:f:")) != -1) {
+    while ((opt = getopt(argc, argv, HOLO_OPTIONS)) != -1) {
+        int applied = parse_object_option(&objects[0], opt, optarg);
+        if (applied < 0) return 1;
+        if (applied) continue;
         switch (opt) {
-            case 's': speedA = atof(optarg); speedB = atof(optarg) / 2.0f; break;
-            case 'a': speedA = atof(optarg); break;
-            case 'b': speedB = atof(optarg); break;
-            case 'w': W = atof(optarg); break;
-            case 'h': H = atof(optarg); break;
             case 'z': manual_zoom = atof(optarg); break;
-            case 't': tilt = atof(optarg); break;
-            case 'W': seg_w = atof(optarg); break;
-            case 'T': seg_t = atof(optarg); break;
-            case 'p': point_len = atof(optarg); break;
-            case 'P': palette = optarg; break;
-            case 'c': contrast = atof(optarg); break;
             case 'd': density = atof(optarg); if(density <= 0) { fprintf(stderr, "Density must be > 0\n"); return 1; } break;
             case 'L': if (sscanf(optarg, "%f,%f", &light_x, &light_y) != 2) { fprintf(stderr, "Invalid light vector. Use x,y\n"); return 1; } break;
-            case 'S': spacing_factor = atof(optarg); break;
-            case 'f': time_date_format = optarg; break;
+            case 'l': use_lod = 1; break;
+            case 'G': use_tiles = 1; break;
+            case 'j': num_threads = atoi(optarg); if(num_threads < 1 || num_threads > JOBS_MAX_WORKERS) { fprintf(stderr, "Thread count must be between 1 and %d\n", JOBS_MAX_WORKERS); return 1; } break;
+            case 'B': bench_frames = atoi(optarg); if(bench_frames <= 0) { fprintf(stderr, "Benchmark frame count must be > 0\n"); return 1; } break;
+            case 'o': output_rate_limit = atof(optarg); if(output_rate_limit <= 0) { fprintf(stderr, "Output rate must be > 0\n"); return 1; } break;
+            case 'q': frame_budget_ms = atof(optarg); if(frame_budget_ms <= 0) { fprintf(stderr, "Frame budget must be > 0\n"); return 1; } break;
+            case 'x': export_path = optarg; break;
+            case 'k': timeline_path = optarg; break;
+            case 'I': keyframe_interval = atoi(optarg); if(keyframe_interval < 1) { fprintf(stderr, "Keyframe interval must be >= 1\n"); return 1; } break;
+            case 'O': if(num_objects == SCENE_MAX_OBJECTS) { fprintf(stderr, "At most %d text objects are supported\n", SCENE_MAX_OBJECTS); return 1; } object_specs[num_objects++] = optarg; break;
             case '?': default: print_usage(argv[0]); return (opt == '?') ? 0 : 1;
         }
     }
 
     // --- Text Handling ---
     // By default, show the current date/time. If user provides arguments, show that text instead.
-    int show_time_date = (argc <= optind);
-    const char* text_to_display;
-    char time_buffer[64]; // Buffer for date/time string, large enough for custom formats
-    char* combined_args = NULL;
+    // Objects added with -O are read once the command line is done, since getopt is restarted for each.
+    int objects_ok = text_object_setup(&objects[0], argv + optind, argc - optind);
+    for (int o = 1; o < num_objects && objects_ok; o++) objects_ok = parse_object_spec(&objects[o], object_specs[o], argv[0]);
+    if (!objects_ok) {
+        free_objects(objects, num_objects);
+        return 1;
+    }
+    TextObject* primary = &objects[0]; // Sets the auto-zoom, and is the one exported
 
-    if (show_time_date) {
-        text_to_display = time_buffer;
-    } else {
-        size_t total_len = 0;
-        for (int i = optind; i < argc; i++) total_len += strlen(argv[i]) + 1;
-        if (!(combined_args = malloc(total_len))) { fprintf(stderr, "Memory allocation failed\n"); return 1; }
-        char* current_pos = combined_args;
-        for (int i = optind; i < argc; i++) {
-            strcpy(current_pos, argv[i]);
-            current_pos += strlen(argv[i]);
-            if (i < argc - 1) *current_pos++ = ' ';
+    QualityController quality = {
+        .budget_ms = frame_budget_ms, .min_density = density, .density = density,
+        .avg_ms = -1.0f, .settle = 0
+    };
+
+
+    // Export mode writes the text's geometry to a file instead of animating it
+    if (export_path) {
+        if (primary->show_time_date) {
+            time_t now = time(NULL);
+            strftime(primary->time_buffer, sizeof(primary->time_buffer), primary->time_date_format, localtime(&now));
+        }
+        int ok = export_text_mesh(export_path, primary->text_to_display, primary->seg_defs, primary->segment_lengths,
+                                  primary->seg_w, primary->seg_t, primary->point_len, primary->char_spacing, primary->tilt);
+        if (!ok) fprintf(stderr, "Cannot write mesh to %s\n", export_path);
+        free_objects(objects, num_objects);
+        return ok ? 0 : 1;
+    }
+
+    // The timeline may give objects other texts than their own, so it is read before anything is sized
+    Timeline timeline = {0};
+    if (timeline_path) {
+        if (!timeline_load(&timeline, timeline_path)) {
+            free_objects(objects, num_objects);
+            return 1;
+        }
+        if (timeline.max_object >= num_objects) {
+            fprintf(stderr, "Timeline animates object %d, but there are only %d\n", timeline.max_object, num_objects);
+            timeline_free(&timeline);
+            free_objects(objects, num_objects);
+            return 1;
+        }
+        for (int o = 0; o < num_objects; o++) {
+            size_t len = timeline_max_text_len(&timeline, o, sizeof(objects[o].time_buffer));
+            if (len > objects[o].max_text_len) objects[o].max_text_len = len;
         }
-        *current_pos = '\0';
-        text_to_display = combined_args;
     }
-    const size_t palette_len = strlen(palette);
 
-    // --- Pre-calculate Program-Level Geometry (do this once!) ---
-    const float quarter_w = W / 4.0f;
-    const float quarter_h = H / 4.0f;
-    const float diag_angle_rad = atan2f(quarter_h, quarter_w);
+    // Transitions keep the text drawn last, and the one the current transition started from
+    for (int o = 0; o < num_objects; o++) {
+        if (!objects[o].transition) continue;
+        if (!(objects[o].shown_text = calloc(2 * (objects[o].max_text_len + 1), 1))) {
+            fprintf(stderr, "Memory allocation failed\n");
+            timeline_free(&timeline);
+            free_objects(objects, num_objects);
+            return 1;
+        }
+        objects[o].transition_from = objects[o].shown_text + objects[o].max_text_len + 1;
+    }
 
-    SegmentDef seg_defs_init[NUM_SEGMENTS] = {
-        {0, H/2, 0}, {W/2, H/4, 90}, {W/2, -H/4, 90}, {0, -H/2, 0}, {-W/2, -H/4, 90}, {-W/2, H/4, 90},
-        {-quarter_w, 0, 0}, {quarter_w, 0, 0}, {-quarter_w, quarter_h, -diag_angle_rad*180.0f/M_PI}, {0, quarter_h, 90}, {quarter_w, quarter_h, diag_angle_rad*180.0f/M_PI},
-        {-quarter_w, -quarter_h, diag_angle_rad*180.0f/M_PI}, {0, -quarter_h, 90}, {quarter_w, -quarter_h, -diag_angle_rad*180.0f/M_PI}
-    };
-    SegmentDef seg_defs[NUM_SEGMENTS];
-    for(int i = 0; i < NUM_SEGMENTS; ++i) {
-        seg_defs[i] = seg_defs_init[i];
-        seg_defs[i].rot_z_rad = seg_defs[i].rot_z_rad * M_PI / 180.0f; // Convert degrees to radians
-        seg_defs[i].cos_ra = cosf(seg_defs[i].rot_z_rad);
-        seg_defs[i].sin_ra = sinf(seg_defs[i].rot_z_rad);
+    // Glyphs of every object together, for sizing the per-frame job state; a changing glyph is drawn in segments
+    size_t max_scene_glyphs = 0;
+    for (int o = 0; o < num_objects; o++) {
+        max_scene_glyphs += objects[o].max_text_len * (objects[o].transition ? NUM_SEGMENTS : 1);
     }
-    const float horiz_len = W / 2.0f - seg_w / 2.0f, vert_outer_len = H / 2.0f - seg_w;
-    const float vert_inner_len = quarter_h - seg_w / 2.0f, diag_len = sqrtf(quarter_w * quarter_w + quarter_h * quarter_h) - seg_w;
-    const float segment_lengths[NUM_SEGMENTS] = {
-        horiz_len, vert_outer_len, vert_outer_len, horiz_len, vert_outer_len, vert_outer_len,
-        horiz_len, horiz_len, diag_len, vert_inner_len, diag_len, diag_len, vert_inner_len, diag_len
-    };
-    const float char_spacing = W * spacing_factor;
 
     // --- Setup Rendering Buffers & State ---
     int sw = 0, sh = 0;
     float zoom = 1.0f;
+    Arena frame_arena = {0}; // Owns every buffer below; re-carved on resize
     float* zbuffer = NULL;
     char* bbuffer = NULL;
-    float A = 0, B = 0;
-
-    // Setup for Frame Rate Control
-#ifdef _WIN32
-    LARGE_INTEGER freq, frame_start;
-    QueryPerformanceFrequency(&freq);
-    const double target_frame_ms = 1000.0 / TARGET_FPS;
-#else
-    const long target_frame_ns = 1000000000L / TARGET_FPS;
-    struct timespec frame_start;
-#endif
-
-    // Setup for Graceful Exit
-    signal(SIGINT, handle_sigint);
-    #ifndef _WIN32
-    signal(SIGWINCH, handle_sigwinch);
-    #endif
-    printf("\x1b[?25l\x1b[2J"); // Hide cursor and clear screen
+    unsigned char* obuffer = NULL; // Object of every cell, when a keyframe holds several objects
+    FrameRing frame_ring = {0}; // Finished frames, handed from the renderer to the presenter thread
+    PresenterThread presenter_thread = {0}; // Writes the latest of them to the terminal
+    TileBinner binner = {0};          // Sorts each frame's points by screen tile
+    JobSystem jobs;                   // Worker threads, when rendering with -j
+    FrameJobs frame_jobs = {0};       // Per-frame state of the glyph and tile jobs
+    const GlyphPoints** frame_glyphs = NULL; // The frame's glyphs, their placements and objects, gathered for the jobs
+    GlyphTransform* frame_transforms = NULL;
+    const RenderContext** frame_contexts = NULL;
+
+    // Keyframe state for frame interpolation (only used when keyframe_interval > 1)
+    float* key_zbuffer = NULL;
+    char* key_bbuffer = NULL;
+    unsigned char* key_obuffer = NULL;
+    RenderContext key_contexts[SCENE_MAX_OBJECTS]; // Every object's transform in the keyframe
+    int frames_until_keyframe = 0;
+
+    // Resize events are coalesced: only the last size of a burst is applied
+    int resize_pending = 0;
+    double resize_deadline_ms = 0;
+
+    // Signals and frame deadlines are delivered through the event loop
+    EventLoop loop;
+    if (event_loop_init(&loop) < 0) {
+        fprintf(stderr, "Event loop setup failed\n");
+        timeline_free(&timeline);
+        free_objects(objects, num_objects);
+        return 1;
+    }
+    if (!job_system_init(&jobs, num_threads)) {
+        fprintf(stderr, "Worker thread creation failed\n");
+        event_loop_close(&loop);
+        timeline_free(&timeline);
+        free_objects(objects, num_objects);
+        return 1;
+    }
+    // Benchmark runs render and encode every frame, but never touch the terminal
+    Presenter presenter = {0};
+    if (bench_frames) presenter.full_repaint = 1;
+    else presenter_init(&presenter, output_rate_limit);
+    int frames_rendered = 0;
+    size_t bytes_encoded = 0;
+    double start_ms = get_time_ms();
 
     // --- MAIN RENDER LOOP ---
     while (running) {
+        // --- Timeline: this frame's values of the animated properties ---
+        float timeline_zoom = 0; // Replaces the auto or manual zoom when set
+        if (timeline_path) {
+            // Wall-clock time, so the show keeps its pace when frames are slow or dropped;
+            // benchmarks count frames instead, so every run renders the same frames
+            float timeline_t = bench_frames ? frames_rendered / (float)TARGET_FPS
+                                            : (float)((get_time_ms() - start_ms) / 1000.0);
+            apply_timeline(&timeline, timeline_t, objects, num_objects, &timeline_zoom, &light_x, &light_y);
+        }
+
         // --- Per-frame text and geometry setup ---
-        int text_len;
-        if (show_time_date) {
-            time_t now = time(NULL);
-            struct tm *tm_info = localtime(&now);
-            strftime(time_buffer, sizeof(time_buffer), time_date_format, tm_info);
-            text_len = strlen(time_buffer);
-        } else {
-            text_len = strlen(text_to_display);
+        for (int o = 0; o < num_objects; o++) {
+            TextObject* obj = &objects[o];
+            if (obj->text_to_display != obj->last_text) {
+                // A new text means new geometry, which can't be interpolated
+                obj->last_text = obj->text_to_display;
+                frames_until_keyframe = 0;
+            }
+            if (obj->show_time_date) {
+                time_t now = time(NULL);
+                struct tm *tm_info = localtime(&now);
+                strftime(obj->time_buffer, sizeof(obj->time_buffer), obj->time_date_format, tm_info);
+                // A new time string means new geometry, which can't be interpolated
+                if (strcmp(obj->time_buffer, obj->last_time_buffer) != 0) {
+                    strcpy(obj->last_time_buffer, obj->time_buffer);
+                    frames_until_keyframe = 0;
+                }
+            }
+            obj->text_len = strlen(obj->text_to_display);
+            if (obj->transition) {
+                // Characters that change in place move from their old segments to their new ones
+                if (strcmp(obj->text_to_display, obj->shown_text) != 0) {
+                    if (strlen(obj->shown_text) == (size_t)obj->text_len) {
+                        memcpy(obj->transition_from, obj->shown_text, obj->text_len + 1);
+                        obj->transition_end = frames_rendered + obj->transition_frames;
+                    } else {
+                        // A new length moves every character: cut a running transition short
+                        // rather than morph from characters that no longer line up
+                        obj->transition_end = frames_rendered;
+                    }
+                    strcpy(obj->shown_text, obj->text_to_display);
+                }
+                // A warped keyframe would hold the transition still
+                if (frames_rendered < obj->transition_end) frames_until_keyframe = 0;
+            }
+            // Likewise for glyphs that move on their own; a resting flip can still be warped
+            if (effect_in_motion(obj, frames_rendered)) frames_until_keyframe = 0;
         }
         // These must be recalculated each frame in time mode as text length can change
-        const float start_x = -(text_len - 1) * char_spacing / 2.0f;
-        const float total_text_3d_width = (text_len > 1) ? (text_len - 1) * char_spacing + W : W;
+        const float total_text_3d_width = (primary->text_len > 1) ? (primary->text_len - 1) * primary->char_spacing + primary->W
+                                                                  : primary->W;
 
-        // Get frame start time for FPS limiting
-#ifdef _WIN32
-        QueryPerformanceCounter(&frame_start);
-#else
-        clock_gettime(CLOCK_MONOTONIC, &frame_start);
-#endif
-        // Handle Terminal Resizing
+        // Start of this frame; sets and checks the resize settle deadline below (the event loop paces frames)
+        double frame_start_ms = get_time_ms();
+
+        // Handle Terminal Resizing. A window drag sends a burst of SIGWINCH, so the
+        // new size is only applied once it has been stable for RESIZE_SETTLE_MS.
         if (terminal_resized) {
-            get_terminal_size(&sw, &sh);
-            sh -= 1; // Avoid scrolling on some terminals
+            terminal_resized = 0;
+            resize_pending = 1;
+            resize_deadline_ms = frame_start_ms + RESIZE_SETTLE_MS;
+        }
+        if (resize_pending && zbuffer && frame_start_ms < resize_deadline_ms) {
+            // Hold the last frame rather than drawing at a size the terminal no longer has
+            event_loop_wait_frame(&loop);
+            continue;
+        }
+        if (resize_pending) {
+            resize_pending = 0;
+            if (bench_frames) {
+                sw = BENCH_COLS;
+                sh = BENCH_ROWS;
+            } else {
+                get_terminal_size(&sw, &sh);
+                sh -= 1; // Avoid scrolling on some terminals
+            }
+
+            size_t buffer_size = (size_t)sw * sh;
+            int use_keyframes = keyframe_interval > 1;
+            int use_obuffer = use_keyframes && num_objects > 1; // A single object needs no per-cell object
+            size_t frame_bytes = arena_align(buffer_size * sizeof(float)) + arena_align(buffer_size)
+                               + presenter_arena_size(sw, sh);
+            if (!bench_frames) frame_bytes += frame_ring_arena_size(sw, sh) + arena_align(buffer_size);
+            for (int o = 0; o < num_objects; o++) frame_bytes += arena_align(objects[o].max_text_len * sizeof(int));
+            if (use_tiles) frame_bytes += tile_binner_arena_size(sw, sh);
+            if (jobs.num_workers > 1) {
+                frame_bytes += arena_align(max_scene_glyphs * sizeof(GlyphPoints*)) + arena_align(max_scene_glyphs * sizeof(GlyphTransform))
+                             + arena_align(max_scene_glyphs * sizeof(RenderContext*));
+            }
+            if (use_keyframes) frame_bytes += arena_align(buffer_size * sizeof(float)) + arena_align(buffer_size);
+            if (use_obuffer) frame_bytes += 2 * arena_align(buffer_size);
 
-            size_t buffer_size = sw * sh;
-            float* new_zbuffer = realloc(zbuffer, buffer_size * sizeof(float));
-            char*  new_bbuffer = realloc(bbuffer, buffer_size * sizeof(char));
+            // The arena is about to be re-carved, including the presenter's output buffer and the ring
+            presenter_thread_stop(&presenter_thread);
+            presenter_drain(&presenter);
 
-            if (!new_zbuffer || !new_bbuffer) {
+            // Keep the block at its high-water mark: shrinking and small growth don't reallocate
+            size_t reserve_bytes = frame_bytes > frame_arena.capacity ? frame_bytes + frame_bytes / ARENA_GROWTH_SLACK : frame_bytes;
+            if (!arena_reserve(&frame_arena, reserve_bytes)) {
                 fprintf(stderr, "Buffer reallocation failed. Exiting.\n");
-                free(new_zbuffer); free(new_bbuffer);
-                free(zbuffer); free(bbuffer);
                 running = 0; continue;
             }
-            zbuffer = new_zbuffer;
-            bbuffer = new_bbuffer;
+            // The arena was sized for all of these, so none of the allocations can fail
+            zbuffer = arena_alloc(&frame_arena, buffer_size * sizeof(float));
+            bbuffer = arena_alloc(&frame_arena, buffer_size);
+            for (int o = 0; o < num_objects; o++) {
+                objects[o].glyph_lods = arena_alloc(&frame_arena, objects[o].max_text_len * sizeof(int));
+                memset(objects[o].glyph_lods, 0, objects[o].max_text_len * sizeof(int)); // All LOD_FULL
+            }
+            presenter_resize(&presenter, &frame_arena, sw, sh);
+            if (!bench_frames) {
+                frame_ring_resize(&frame_ring, &frame_arena, sw, sh);
+                if (!presenter_thread_start(&presenter_thread, &presenter, &frame_ring, arena_alloc(&frame_arena, buffer_size))) {
+                    fprintf(stderr, "Presenter thread creation failed. Exiting.\n");
+                    running = 0; continue;
+                }
+            }
+            if (use_tiles) tile_binner_resize(&binner, &frame_arena, sw, sh);
+            if (jobs.num_workers > 1) {
+                frame_glyphs = arena_alloc(&frame_arena, max_scene_glyphs * sizeof(GlyphPoints*));
+                frame_transforms = arena_alloc(&frame_arena, max_scene_glyphs * sizeof(GlyphTransform));
+                frame_contexts = arena_alloc(&frame_arena, max_scene_glyphs * sizeof(RenderContext*));
+            }
+            if (use_keyframes) {
+                key_zbuffer = arena_alloc(&frame_arena, buffer_size * sizeof(float));
+                key_bbuffer = arena_alloc(&frame_arena, buffer_size);
+            }
+            if (use_obuffer) {
+                obuffer = arena_alloc(&frame_arena, buffer_size);
+                key_obuffer = arena_alloc(&frame_arena, buffer_size);
+            }
+            frames_until_keyframe = 0; // The old keyframe doesn't match the new screen
 
             if (manual_zoom <= 0) {
-                // Auto-zoom calculation now uses the per-frame text width
-                float zoom_h = (sh * SCREEN_PADDING_FACTOR) * CAMERA_DISTANCE / H;
+                // Auto-zoom calculation now uses the per-frame text width of the first object
+                float zoom_h = (sh * SCREEN_PADDING_FACTOR) * CAMERA_DISTANCE / primary->H;
                 float zoom_w = (sw * SCREEN_PADDING_FACTOR) * CAMERA_DISTANCE / (total_text_3d_width * 2.0f);
                 zoom = fminf(zoom_h, zoom_w) / 1;
             } else {
                 zoom = manual_zoom;
             }
-            printf("\x1b[2J");
-            terminal_resized = 0;
         }
 
-        // Create and populate the RenderContext for this frame
-        RenderContext ctx = {
-            .zbuffer = zbuffer, .bbuffer = bbuffer,
-            .sw = sw, .sh = sh,
-            .cosA = cosf(A), .sinA = sinf(A),
-            .cosB = cosf(B), .sinB = sinf(B),
-            .zoom = zoom, .tilt_factor = tilt,
-            .light_x = light_x, .light_y = light_y,
-            .contrast = contrast,
-            .palette = palette, .palette_len = palette_len
-        };
+        // Create and populate the RenderContext of every object for this frame
+        RenderContext contexts[SCENE_MAX_OBJECTS];
+        for (int o = 0; o < num_objects; o++) {
+            const TextObject* obj = &objects[o];
+            contexts[o] = (RenderContext){
+                .zbuffer = zbuffer, .bbuffer = bbuffer, .obuffer = obuffer,
+                .sw = sw, .sh = sh, .binner = use_tiles ? &binner : NULL,
+                .offset_x = obj->pos_x, .offset_y = obj->pos_y, .offset_z = obj->pos_z,
+                .object = (unsigned char)o,
+                .zoom = timeline_zoom > 0 ? timeline_zoom : zoom, .tilt_factor = obj->tilt,
+                .light_x = light_x, .light_y = light_y,
+                .contrast = obj->contrast,
+                .palette = obj->palette, .palette_len = obj->palette_len
+            };
+            render_context_orient(&contexts[o], text_object_orientation(obj));
+        }
 
         // Clear buffers for the new frame
         memset(bbuffer, ' ', sw * sh);
         memset(zbuffer, 0, sw * sh * sizeof(float));
 
-        // Iterate through each character in the input string
-        for (int char_idx = 0; char_idx < text_len; char_idx++) {
-            char c = text_to_display[char_idx];
-            if (c < ASCII_OFFSET || c >= ASCII_OFFSET + SUPPORTED_CHARS) c = ' ';
-            uint16_t seg_data = FourteenSegmentASCII[c - ASCII_OFFSET];
-            float char_center_x = start_x + char_idx * char_spacing;
-
-            // Iterate through the 14 possible segments for the character
-            for (int i = 0; i < NUM_SEGMENTS; i++) {
-                if ((seg_data >> i) & 1) { // Check if this segment should be drawn
-                    draw_pointy_segment(segment_lengths[i], seg_w, seg_t, point_len, &seg_defs[i], char_center_x, density, &ctx);
+        // In-between frames reuse the last keyframe instead of drawing the segments
+        if (frames_until_keyframe > 0) {
+            warp_keyframe(key_zbuffer, key_bbuffer, key_obuffer, key_contexts, contexts, num_objects);
+        } else {
+            // Resampling for a new density is part of what the quality controller pays for it
+            double render_start_ms = get_time_ms();
+            int prepared = 1;
+            for (int o = 0; o < num_objects && prepared; o++) {
+                prepared = text_object_prepare(&objects[o], quality.density, use_lod ? LOD_LEVELS : 1);
+            }
+            if (!prepared) {
+                running = 0; continue;
+            }
+
+            // Iterate through each character of every object; they all share the Z-buffer
+            int num_glyphs = 0;
+            for (int o = 0; o < num_objects; o++) {
+                TextObject* obj = &objects[o];
+                const RenderContext* ctx = &contexts[o];
+                const float start_x = -(obj->text_len - 1) * obj->char_spacing / 2.0f;
+                const float progress = (frames_rendered < obj->transition_end)
+                                     ? 1.0f - (obj->transition_end - frames_rendered) / (float)obj->transition_frames : -1.0f;
+                for (int char_idx = 0; char_idx < obj->text_len; char_idx++) {
+                    char c = obj->text_to_display[char_idx];
+                    if (c < ASCII_OFFSET || c >= ASCII_OFFSET + SUPPORTED_CHARS) c = ' ';
+                    float char_center_x = start_x + char_idx * obj->char_spacing;
+
+                    GlyphTransform xf;
+                    place_glyph(obj, ctx, char_idx, char_center_x, frames_rendered, &xf);
+
+                    if (use_lod) {
+                        // Depth of the glyph center decides how large its segments appear
+                        float seg_rows = ctx->zoom * fmaxf(obj->seg_w, obj->seg_t) / fmaxf(xf.t[2], 1e-3f);
+                        obj->glyph_lods[char_idx] = select_lod(seg_rows, obj->glyph_lods[char_idx]);
+                    }
+
+                    // The glyph's segments, merged into one point set, or one by one while the character changes
+                    const GlyphPoints* pieces[NUM_SEGMENTS];
+                    GlyphTransform placements[NUM_SEGMENTS];
+                    pieces[0] = &obj->glyph_cache->glyphs[c - ASCII_OFFSET][obj->glyph_lods[char_idx]];
+                    const GlyphTransform* placed = &xf;
+                    int num_pieces = 1;
+                    if (progress >= 0.0f) {
+                        char from = obj->transition_from[char_idx];
+                        if (from < ASCII_OFFSET || from >= ASCII_OFFSET + SUPPORTED_CHARS) from = ' ';
+                        if (from != c) {
+                            num_pieces = transition_pieces(obj, from, c, progress, obj->glyph_lods[char_idx], &xf,
+                                                           pieces, placements);
+                            placed = placements;
+                        }
+                    }
+                    for (int p = 0; p < num_pieces; p++) {
+                        if (jobs.num_workers > 1) {
+                            frame_glyphs[num_glyphs] = pieces[p];
+                            frame_transforms[num_glyphs] = placed[p];
+                            frame_contexts[num_glyphs++] = ctx;
+                        } else {
+                            draw_glyph(pieces[p], &placed[p], ctx);
+                        }
+                    }
                 }
             }
-        }
+            if (jobs.num_workers > 1) {
+                if (!draw_glyphs_parallel(&frame_jobs, &jobs, frame_glyphs, frame_transforms, frame_contexts, num_glyphs,
+                                          &contexts[0])) {
+                    fprintf(stderr, "Job allocation failed. Exiting.\n");
+                    running = 0; continue;
+                }
+            } else {
+                tile_binner_flush(&contexts[0]);
+            }
+
+            // Only full renders are measured; warped frames say nothing about the sampling cost
+            if (quality.budget_ms > 0) quality_update(&quality, (float)(get_time_ms() - render_start_ms));
 
-        // Print the buffer to the screen
-        printf("\x1b[H");
-        for (int y = 0; y < sh; y++) {
-            fwrite(bbuffer + y * sw, 1, sw, stdout);
-            putchar('\n');
+            // Keep this frame as the source for the following in-between frames
+            if (keyframe_interval > 1) {
+                memcpy(key_zbuffer, zbuffer, sw * sh * sizeof(float));
+                memcpy(key_bbuffer, bbuffer, sw * sh);
+                if (key_obuffer) memcpy(key_obuffer, obuffer, sw * sh);
+                memcpy(key_contexts, contexts, num_objects * sizeof(RenderContext));
+                frames_until_keyframe = keyframe_interval;
+            }
+        }
+        if (frames_until_keyframe > 0) frames_until_keyframe--;
+
+        // Hand the frame to the presenter thread and draw the next one into bbuffer right away.
+        // Benchmarks encode every frame here instead, so their bytes and checksums don't
+        // depend on which frames the thread would have skipped.
+        if (bench_frames) {
+            encode_frame(&presenter, bbuffer);
+            bytes_encoded += presenter.out_len;
+        } else {
+            frame_ring_publish(&frame_ring, bbuffer);
+            presenter_thread_notify(&presenter_thread);
         }
-        fflush(stdout);
+        frames_rendered++;
 
         // Update animation angles for the next frame
-        A += speedA;
-        B += speedB;
-
-        // Calculate elapsed time and sleep for the remainder to cap FPS
-#ifdef _WIN32
-        LARGE_INTEGER frame_end;
-        QueryPerformanceCounter(&frame_end);
-        double elapsed_ms = (frame_end.QuadPart - frame_start.QuadPart) * 1000.0 / freq.QuadPart;
-        if (elapsed_ms < target_frame_ms) {
-            Sleep((DWORD)(target_frame_ms - elapsed_ms));
+        for (int o = 0; o < num_objects; o++) {
+            objects[o].A += objects[o].speedA;
+            objects[o].B += objects[o].speedB;
+            objects[o].C += objects[o].speedC;
+            objects[o].spin += objects[o].axis_speed;
         }
-#else
-        struct timespec frame_end;
-        clock_gettime(CLOCK_MONOTONIC, &frame_end);
-        long elapsed_ns = (frame_end.tv_sec - frame_start.tv_sec) * 1000000000L + (frame_end.tv_nsec - frame_start.tv_nsec);
-
-        if (elapsed_ns < target_frame_ns) {
-            struct timespec sleep_time;
-            long remainder_ns = target_frame_ns - elapsed_ns;
-            sleep_time.tv_sec = remainder_ns / 1000000000L;
-            sleep_time.tv_nsec = remainder_ns % 1000000000L;
-            nanosleep(&sleep_time, NULL);
+
+        // Sleep until the next frame is due
+        if (bench_frames) {
+            event_loop_poll_signals(&loop); // Never waits for a frame, but still stops on SIGINT and SIGTERM
+            if (frames_rendered >= bench_frames) running = 0;
+        } else {
+            event_loop_wait_frame(&loop);
         }
-#endif
+    }
+
+    if (bench_frames && frames_rendered > 0) {
+        // The checksum of the last frame lets optimizations be checked against a reference build
+        double seconds = (get_time_ms() - start_ms) / 1000.0;
+        uint64_t checksum = hash_row(bbuffer, sw * sh);
+        printf("frames: %d  time: %.3f s  fps: %.1f  bytes/frame: %zu  checksum: %016llx\n",
+               frames_rendered, seconds, frames_rendered / seconds, bytes_encoded / frames_rendered,
+               (unsigned long long)checksum);
     }
 
     // --- Cleanup ---
-    printf("\x1b[?25h\n"); // Show cursor again and move to a new line
-    free(zbuffer);
-    free(bbuffer);
-    if (combined_args) free(combined_args);
+    presenter_thread_stop(&presenter_thread);
+    if (!bench_frames) presenter_shutdown(&presenter);
+    event_loop_close(&loop);
+    job_system_shutdown(&jobs);
+    frame_jobs_free(&frame_jobs);
+    arena_free(&frame_arena);
+    timeline_free(&timeline);
+    free_objects(objects, num_objects);
 
     return 0;
 }
@@ -0,0 +1,234 @@
+/**
+ * jobs.c - Work-stealing job system
+ *
+ * Copyright (c) 2025 Olivier Coz
+ *
+ * This software is released under the MIT License.
+ * See the LICENSE file for details.
+ */
+
+#include "jobs.h"
+
+#include <stdlib.h>
+
+#ifdef HAVE_JOB_THREADS
+#include <sched.h> // For sched_yield() while waiting for stolen jobs to finish
+
+#define JOB_EMPTY -1 // Returned by the deque operations when there is nothing to take
+
+
+// --- Deque ---
+// Chase-Lev with the C11 orderings of Le, Pop, Cohen and Zappa Nardelli,
+// "Correct and Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+
+static void deque_push(JobDeque* deque, long mask, int job) {
+    long b = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    atomic_store_explicit(&deque->slots[b & mask], job, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+}
+
+static int deque_take(JobDeque* deque, long mask) {
+    long b = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&deque->top, memory_order_relaxed);
+    if (t > b) {
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+        return JOB_EMPTY;
+    }
+    int job = atomic_load_explicit(&deque->slots[b & mask], memory_order_relaxed);
+    if (t == b) {
+        // Last job: race the thieves for it
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, memory_order_seq_cst,
+                                                     memory_order_relaxed)) {
+            job = JOB_EMPTY;
+        }
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+    }
+    return job;
+}
+
+static int deque_steal(JobDeque* deque, long mask) {
+    long t = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (t >= b) return JOB_EMPTY;
+    int job = atomic_load_explicit(&deque->slots[t & mask], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        return JOB_EMPTY; // Lost the race; the caller looks again
+    }
+    return job;
+}
+
+
+// --- Workers ---
+
+/**
+ * @brief Runs jobs of the current batch until none is left unfinished.
+ * Own jobs come from the bottom of the worker's deque; when it is empty the
+ * other deques are robbed in turn, starting with the next worker.
+ */
+static void work_until_done(JobSystem* jobs, int id) {
+    const long mask = jobs->capacity - 1;
+    while (atomic_load_explicit(&jobs->remaining, memory_order_acquire) > 0) {
+        int job = deque_take(&jobs->workers[id].deque, mask);
+        for (int i = 1; job == JOB_EMPTY && i < jobs->num_workers; i++) {
+            job = deque_steal(&jobs->workers[(id + i) % jobs->num_workers].deque, mask);
+        }
+        if (job == JOB_EMPTY) {
+            sched_yield(); // Every job is taken; wait for the last ones to finish
+            continue;
+        }
+        jobs->fn(jobs->data, job, id);
+        atomic_fetch_sub_explicit(&jobs->remaining, 1, memory_order_release);
+    }
+}
+
+static void* worker_main(void* arg) {
+    JobWorker* worker = arg;
+    JobSystem* jobs = worker->jobs;
+    unsigned long seen = 0;
+    for (;;) {
+        pthread_mutex_lock(&jobs->lock);
+        while (jobs->generation == seen && !jobs->quit) pthread_cond_wait(&jobs->wake, &jobs->lock);
+        if (jobs->quit) {
+            pthread_mutex_unlock(&jobs->lock);
+            return NULL;
+        }
+        seen = jobs->generation;
+        pthread_mutex_unlock(&jobs->lock);
+
+        work_until_done(jobs, worker->id);
+
+        pthread_mutex_lock(&jobs->lock);
+        if (--jobs->active == 0) pthread_cond_signal(&jobs->idle);
+        pthread_mutex_unlock(&jobs->lock);
+    }
+}
+
+/**
+ * @brief Makes every deque hold at least `count` jobs. Only called while the workers are parked.
+ */
+static int reserve_deques(JobSystem* jobs, int count) {
+    if (count <= jobs->capacity) return 1;
+    long capacity = jobs->capacity > 0 ? jobs->capacity : 64;
+    while (capacity < count) capacity *= 2;
+    for (int i = 0; i < jobs->num_workers; i++) {
+        atomic_int* slots = realloc(jobs->workers[i].deque.slots, capacity * sizeof(atomic_int));
+        if (!slots) return 0;
+        jobs->workers[i].deque.slots = slots;
+    }
+    jobs->capacity = capacity;
+    return 1;
+}
+#endif
+
+
+// --- Job System ---
+
+/**
+ * @brief Starts a pool of `num_workers` threads, the calling thread included.
+ * Without thread support the pool has a single worker, the caller.
+ * @return 1 on success, 0 if the threads could not be created.
+ */
+int job_system_init(JobSystem* jobs, int num_workers) {
+    jobs->num_workers = num_workers < 1 ? 1 : (num_workers > JOBS_MAX_WORKERS ? JOBS_MAX_WORKERS : num_workers);
+#ifdef HAVE_JOB_THREADS
+    jobs->capacity = 0;
+    jobs->started = 0;
+    jobs->generation = 0;
+    jobs->active = 0;
+    jobs->quit = 0;
+    atomic_init(&jobs->remaining, 0);
+    pthread_mutex_init(&jobs->lock, NULL);
+    pthread_cond_init(&jobs->wake, NULL);
+    pthread_cond_init(&jobs->idle, NULL);
+    for (int i = 0; i < jobs->num_workers; i++) {
+        JobWorker* worker = &jobs->workers[i];
+        worker->jobs = jobs;
+        worker->id = i;
+        atomic_init(&worker->deque.top, 0);
+        atomic_init(&worker->deque.bottom, 0);
+        worker->deque.slots = NULL;
+    }
+    for (int i = 1; i < jobs->num_workers; i++) {
+        if (pthread_create(&jobs->workers[i].thread, NULL, worker_main, &jobs->workers[i]) != 0) {
+            job_system_shutdown(jobs);
+            return 0;
+        }
+        jobs->started++;
+    }
+#else
+    jobs->num_workers = 1;
+#endif
+    return 1;
+}
+
+/**
+ * @brief Stops and joins the worker threads. Must not be called while a batch is running.
+ */
+void job_system_shutdown(JobSystem* jobs) {
+#ifdef HAVE_JOB_THREADS
+    pthread_mutex_lock(&jobs->lock);
+    jobs->quit = 1;
+    pthread_cond_broadcast(&jobs->wake);
+    pthread_mutex_unlock(&jobs->lock);
+    for (int i = 1; i <= jobs->started; i++) pthread_join(jobs->workers[i].thread, NULL);
+    for (int i = 0; i < jobs->num_workers; i++) {
+        free(jobs->workers[i].deque.slots);
+        jobs->workers[i].deque.slots = NULL;
+    }
+    pthread_cond_destroy(&jobs->idle);
+    pthread_cond_destroy(&jobs->wake);
+    pthread_mutex_destroy(&jobs->lock);
+    jobs->started = 0;
+#endif
+    jobs->num_workers = 1;
+}
+
+/**
+ * @brief Runs fn(data, i, worker) for every i in [0, count) and waits for all of them.
+ * Jobs may run in any order and on any worker; they must only touch data no
+ * other job of the batch writes. Each worker starts with a contiguous share
+ * of the batch, so neighbouring jobs tend to run on the same thread.
+ * @return 1 when the batch ran, 0 if the deques could not grow (nothing ran).
+ */
+int job_system_run(JobSystem* jobs, JobFn fn, void* data, int count) {
+    if (count <= 0) return 1;
+#ifdef HAVE_JOB_THREADS
+    if (jobs->num_workers > 1) {
+        if (!reserve_deques(jobs, count)) return 0;
+        // Workers are parked, so any thread may fill their deques. The owner
+        // takes from the bottom, so shares are pushed last job first.
+        for (int i = 0; i < jobs->num_workers; i++) {
+            JobDeque* deque = &jobs->workers[i].deque;
+            int first = (int)((long)count * i / jobs->num_workers);
+            int last = (int)((long)count * (i + 1) / jobs->num_workers);
+            atomic_store_explicit(&deque->top, 0, memory_order_relaxed);
+            atomic_store_explicit(&deque->bottom, 0, memory_order_relaxed);
+            for (int job = last - 1; job >= first; job--) deque_push(deque, jobs->capacity - 1, job);
+        }
+        jobs->fn = fn;
+        jobs->data = data;
+        atomic_store_explicit(&jobs->remaining, count, memory_order_relaxed);
+
+        pthread_mutex_lock(&jobs->lock);
+        jobs->generation++;
+        jobs->active = jobs->num_workers - 1;
+        pthread_cond_broadcast(&jobs->wake);
+        pthread_mutex_unlock(&jobs->lock);
+
+        work_until_done(jobs, 0);
+
+        // Frame barrier: every worker has left the batch before the next one is seeded
+        pthread_mutex_lock(&jobs->lock);
+        while (jobs->active > 0) pthread_cond_wait(&jobs->idle, &jobs->lock);
+        pthread_mutex_unlock(&jobs->lock);
+        return 1;
+    }
+#endif
+    for (int i = 0; i < count; i++) fn(data, i, 0);
+    return 1;
+}
@@ -0,0 +1,82 @@
+/**
+ * jobs.h - Work-stealing job system
+ *
+ * Copyright (c) 2025 Olivier Coz
+ *
+ * This software is released under the MIT License.
+ * See the LICENSE file for details.
+ */
+
+#ifndef HOLO_JOBS_H
+#define HOLO_JOBS_H
+
+// Worker threads need POSIX threads; on Windows every batch runs on the calling thread
+#ifndef _WIN32
+#define HAVE_JOB_THREADS 1
+#include <pthread.h>
+#include <stdatomic.h>
+#endif
+
+#define JOBS_MAX_WORKERS 64 // Upper bound for -j, the calling thread included
+
+/**
+ * @brief A batch job: runs item `index` of the batch on worker `worker` (0 is the calling thread).
+ */
+typedef void (*JobFn)(void* data, int index, int worker);
+
+typedef struct JobSystem JobSystem;
+
+#ifdef HAVE_JOB_THREADS
+/**
+ * @brief Chase-Lev deque of job indices.
+ * The owning worker pushes and takes at the bottom; other workers steal from
+ * the top. Batches are seeded while every worker is parked, so the ring
+ * never needs to grow while it is shared.
+ */
+typedef struct {
+    _Alignas(64) atomic_long top;    // Next index a thief takes
+    _Alignas(64) atomic_long bottom; // One past the last index; written by the owner only
+    atomic_int* slots;               // Ring of `capacity` job indices
+} JobDeque;
+
+typedef struct {
+    JobSystem* jobs;
+    int id;
+    pthread_t thread;
+    JobDeque deque;
+} JobWorker;
+#endif
+
+/**
+ * @brief A pool of workers that runs batches of independent jobs.
+ * job_system_run seeds each worker's deque with a share of the batch; a
+ * worker that runs out steals from the others, so uneven jobs still keep
+ * every thread busy. The call returns once the whole batch is done.
+ */
+struct JobSystem {
+    int num_workers; // Threads running jobs, the calling thread included
+#ifdef HAVE_JOB_THREADS
+    JobWorker workers[JOBS_MAX_WORKERS];
+    long capacity; // Slots in every deque, a power of two
+    int  started;  // Worker threads created so far
+
+    // Current batch
+    JobFn fn;
+    void* data;
+    atomic_int remaining; // Jobs of the batch not finished yet
+
+    // Parking between batches
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;     // Signaled when a batch starts or the pool shuts down
+    pthread_cond_t  idle;     // Signaled when the last worker leaves a batch
+    unsigned long generation; // Batches started so far
+    int active;               // Worker threads still inside the current batch
+    int quit;                 // Set on shutdown
+#endif
+};
+
+int job_system_init(JobSystem* jobs, int num_workers);
+void job_system_shutdown(JobSystem* jobs);
+int job_system_run(JobSystem* jobs, JobFn fn, void* data, int count);
+
+#endif // HOLO_JOBS_H
@@ -0,0 +1,155 @@
+/**
+ * mesh.c - Explicit segment geometry and mesh export
+ *
+ * Copyright (c) 2025 Olivier Coz
+ *
+ * This software is released under the MIT License.
+ * See the LICENSE file for details.
+ */
+
+#include "mesh.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+
+// --- Segment Mesh ---
+
+static Vec3 vec3_normalize(Vec3 v) {
+    float len = sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+    if (len < 1e-9f) return (Vec3){ 0, 0, 0 }; // Degenerate face (e.g. no pointy ends)
+    return (Vec3){ v.x / len, v.y / len, v.z / len };
+}
+
+/**
+ * @brief Builds the mesh of a segment with the given dimensions.
+ * Vertices 0-5 outline the hexagon on the front (+Z) side, counter-clockwise
+ * from the +X tip; vertices 6-11 are the same outline on the back side.
+ * @param length Length of the flat part, without the pointy ends.
+ * @param seg_w, seg_t Width (Y) and thickness (Z) of the segment.
+ * @param point_len Length of each pointy end.
+ */
+void segment_mesh_build(SegmentMesh* mesh, float length, float seg_w, float seg_t, float point_len) {
+    const float hl = length / 2.0f, hw = seg_w / 2.0f, ht = seg_t / 2.0f;
+    const float outline[6][2] = {
+        { hl + point_len, 0 }, { hl, hw }, { -hl, hw }, { -hl - point_len, 0 }, { -hl, -hw }, { hl, -hw }
+    };
+    for (int i = 0; i < 6; i++) {
+        mesh->vertices[i]     = (Vec3){ outline[i][0], outline[i][1], ht };
+        mesh->vertices[i + 6] = (Vec3){ outline[i][0], outline[i][1], -ht };
+    }
+
+    int f = 0;
+    // Caps: triangle fans from the +X tip, reversed on the back so both face outwards
+    for (int i = 1; i < 5; i++) {
+        mesh->faces[f][0] = 0; mesh->faces[f][1] = i;         mesh->faces[f][2] = i + 1;     f++;
+        mesh->faces[f][0] = 6; mesh->faces[f][1] = i + 7;     mesh->faces[f][2] = i + 6;     f++;
+    }
+    // Sides: one quad per outline edge, split in two triangles
+    for (int i = 0; i < 6; i++) {
+        int j = (i + 1) % 6;
+        mesh->faces[f][0] = i; mesh->faces[f][1] = i + 6; mesh->faces[f][2] = j + 6; f++;
+        mesh->faces[f][0] = i; mesh->faces[f][1] = j + 6; mesh->faces[f][2] = j;     f++;
+    }
+
+    for (f = 0; f < SEGMENT_MESH_FACES; f++) {
+        Vec3 a = mesh->vertices[mesh->faces[f][0]];
+        Vec3 b = mesh->vertices[mesh->faces[f][1]];
+        Vec3 c = mesh->vertices[mesh->faces[f][2]];
+        Vec3 ab = { b.x - a.x, b.y - a.y, b.z - a.z };
+        Vec3 ac = { c.x - a.x, c.y - a.y, c.z - a.z };
+        mesh->normals[f] = vec3_normalize((Vec3){
+            ab.y * ac.z - ab.z * ac.y, ab.z * ac.x - ab.x * ac.z, ab.x * ac.y - ab.y * ac.x
+        });
+    }
+}
+
+
+// --- Export ---
+
+/**
+ * @brief Moves a segment-local point to its place in the text, as the renderer does.
+ * The segment is rotated and translated into the character, then the italic
+ * shear is applied.
+ */
+static Vec3 place_point(Vec3 p, const SegmentDef* def, float char_center_x, float tilt_factor) {
+    float x = p.x * def->cos_ra - p.y * def->sin_ra + def->pos_x + char_center_x;
+    float y = p.x * def->sin_ra + p.y * def->cos_ra + def->pos_y;
+    return (Vec3){ x + y * tilt_factor, y, p.z };
+}
+
+/**
+ * @brief Transforms a face normal like place_point transforms positions.
+ * The shear is not a rotation, so normals go through its inverse transpose.
+ */
+static Vec3 place_normal(Vec3 n, const SegmentDef* def, float tilt_factor) {
+    float x = n.x * def->cos_ra - n.y * def->sin_ra;
+    float y = n.x * def->sin_ra + n.y * def->cos_ra;
+    return vec3_normalize((Vec3){ x, y - x * tilt_factor, n.z });
+}
+
+/**
+ * @brief Writes the geometry of a text as a triangle mesh for offline rendering.
+ * Glyphs are laid out exactly as on screen (before the animation rotation).
+ * The format follows the file extension: ASCII STL for ".stl", Wavefront OBJ
+ * otherwise. Degenerate faces (pointy ends of zero length) are left out.
+ * @return 1 on success, 0 if the file could not be written.
+ */
+int export_text_mesh(const char* path, const char* text, const SegmentDef seg_defs[NUM_SEGMENTS],
+                     const float segment_lengths[NUM_SEGMENTS], float seg_w, float seg_t, float point_len,
+                     float char_spacing, float tilt_factor)
+{
+    const char* ext = strrchr(path, '.');
+    const int stl = ext && (strcmp(ext, ".stl") == 0 || strcmp(ext, ".STL") == 0);
+    FILE* out = fopen(path, "w");
+    if (!out) return 0;
+
+    const int text_len = strlen(text);
+    const float start_x = -(text_len - 1) * char_spacing / 2.0f;
+    int first_vertex = 1, first_normal = 1; // OBJ indices are 1-based and global to the file
+
+    if (stl) fprintf(out, "solid holo\n");
+    else fprintf(out, "# holo: \"%s\"\n", text);
+    for (int char_idx = 0; char_idx < text_len; char_idx++) {
+        char c = text[char_idx];
+        if (c < ASCII_OFFSET || c >= ASCII_OFFSET + SUPPORTED_CHARS) c = ' ';
+        uint16_t seg_data = FourteenSegmentASCII[c - ASCII_OFFSET];
+        float char_center_x = start_x + char_idx * char_spacing;
+
+        for (int i = 0; i < NUM_SEGMENTS; i++) {
+            if (!((seg_data >> i) & 1)) continue;
+            SegmentMesh mesh;
+            segment_mesh_build(&mesh, segment_lengths[i], seg_w, seg_t, point_len);
+            Vec3 v[SEGMENT_MESH_VERTICES];
+            for (int k = 0; k < SEGMENT_MESH_VERTICES; k++) {
+                v[k] = place_point(mesh.vertices[k], &seg_defs[i], char_center_x, tilt_factor);
+            }
+
+            if (!stl) {
+                for (int k = 0; k < SEGMENT_MESH_VERTICES; k++) fprintf(out, "v %f %f %f\n", v[k].x, v[k].y, v[k].z);
+            }
+            for (int f = 0; f < SEGMENT_MESH_FACES; f++) {
+                Vec3 n = place_normal(mesh.normals[f], &seg_defs[i], tilt_factor);
+                if (n.x == 0 && n.y == 0 && n.z == 0) continue;
+                const int* face = mesh.faces[f];
+                if (stl) {
+                    fprintf(out, "facet normal %f %f %f\n outer loop\n", n.x, n.y, n.z);
+                    for (int k = 0; k < 3; k++) fprintf(out, "  vertex %f %f %f\n", v[face[k]].x, v[face[k]].y, v[face[k]].z);
+                    fprintf(out, " endloop\nendfacet\n");
+                } else {
+                    fprintf(out, "vn %f %f %f\n", n.x, n.y, n.z);
+                    fprintf(out, "f %d//%d %d//%d %d//%d\n", first_vertex + face[0], first_normal, first_vertex + face[1], first_normal,
+                            first_vertex + face[2], first_normal);
+                    first_normal++;
+                }
+            }
+            first_vertex += SEGMENT_MESH_VERTICES;
+        }
+    }
+    if (stl) fprintf(out, "endsolid holo\n");
+
+    int ok = !ferror(out);
+    if (fclose(out) != 0) ok = 0;
+    return ok;
+}
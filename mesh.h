@@ -0,0 +1,43 @@
+/**
+ * mesh.h - Explicit segment geometry and mesh export
+ *
+ * Copyright (c) 2025 Olivier Coz
+ *
+ * This software is released under the MIT License.
+ * See the LICENSE file for details.
+ */
+
+#ifndef HOLO_MESH_H
+#define HOLO_MESH_H
+
+#include "font.h"
+
+#define SEGMENT_MESH_VERTICES 12 // Hexagonal outline, front and back
+#define SEGMENT_MESH_FACES    20 // Two hexagonal caps of 4 triangles, 6 sides of 2 triangles
+
+typedef struct {
+    float x, y, z;
+} Vec3;
+
+/**
+ * @brief Closed triangle mesh of one segment, in segment-local space.
+ * The segment lies along X, centered on the origin: a box of the given length,
+ * width (Y) and thickness (Z) with a pointy end of `point_len` on each side,
+ * i.e. a hexagonal prism. Faces are wound counter-clockwise seen from outside
+ * and each has a unit normal. Only -x uses it: the renderer's point templates
+ * come from sample_segment, whose open pointy-end caps and stretched LOD boxes
+ * are not a closed solid.
+ */
+typedef struct {
+    Vec3 vertices[SEGMENT_MESH_VERTICES];
+    int  faces[SEGMENT_MESH_FACES][3];
+    Vec3 normals[SEGMENT_MESH_FACES];
+} SegmentMesh;
+
+void segment_mesh_build(SegmentMesh* mesh, float length, float seg_w, float seg_t, float point_len);
+
+int export_text_mesh(const char* path, const char* text, const SegmentDef seg_defs[NUM_SEGMENTS],
+                     const float segment_lengths[NUM_SEGMENTS], float seg_w, float seg_t, float point_len,
+                     float char_spacing, float tilt_factor);
+
+#endif // HOLO_MESH_H
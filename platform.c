@@ -0,0 +1,285 @@
+/**
+ * platform.c - Signals, timing, event loop and memory arena
+ *
+ * Copyright (c) 2025 Olivier Coz
+ *
+ * This software is released under the MIT License.
+ * See the LICENSE file for details.
+ */
+
+#include "platform.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h> // For graceful exit and window resizing
+#include <errno.h>
+
+// Platform-specific includes
+#ifdef _WIN32
+#include <windows.h>
+#include <malloc.h> // For _aligned_malloc()
+#else
+#include <sys/mman.h> // For mmap() and madvise() backing large arenas
+#include <time.h> // For nanosleep and clock_gettime
+#endif
+
+// Event notification for the frame loop
+#ifdef HAVE_EPOLL_LOOP
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#endif
+
+
+// --- Globals for Signal Handling ---
+volatile int running = 1;
+volatile int terminal_resized = 1; // Start at 1 to trigger initial setup
+
+
+// --- Platform-Specific Terminal Size Detection ---
+#ifdef _WIN32
+void get_terminal_size(int* width, int* height) {
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi);
+    *width = csbi.srWindow.Right - csbi.srWindow.Left + 1;
+    *height = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
+}
+#else
+#include <sys/ioctl.h>
+void get_terminal_size(int* width, int* height) {
+    struct winsize w;
+    ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
+    *width = w.ws_col;
+    *height = w.ws_row;
+}
+#endif
+
+/**
+ * @brief Returns a monotonic timestamp in milliseconds.
+ */
+double get_time_ms(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return now.QuadPart * 1000.0 / freq.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+#endif
+}
+
+
+
+// --- Event Loop ---
+
+#ifdef HAVE_EPOLL_LOOP
+/**
+ * @brief Releases the loop's file descriptors.
+ */
+void event_loop_close(EventLoop* loop) {
+    if (loop->timer_fd >= 0) close(loop->timer_fd);
+    if (loop->signal_fd >= 0) close(loop->signal_fd);
+    if (loop->epoll_fd >= 0) close(loop->epoll_fd);
+    loop->epoll_fd = loop->signal_fd = loop->timer_fd = -1;
+}
+
+/**
+ * @brief Routes the handled signals to a signalfd and starts the frame timer.
+ * @return 0 on success, -1 on failure.
+ */
+int event_loop_init(EventLoop* loop) {
+    loop->epoll_fd = loop->signal_fd = loop->timer_fd = -1;
+
+    // The signals are blocked so they are only ever delivered through the signalfd
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGWINCH);
+    if (sigprocmask(SIG_BLOCK, &mask, NULL) < 0) return -1;
+
+    const long period_ns = 1000000000L / TARGET_FPS;
+    struct itimerspec period = {
+        .it_interval = { .tv_sec = 0, .tv_nsec = period_ns },
+        .it_value    = { .tv_sec = 0, .tv_nsec = period_ns }
+    };
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    loop->signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    loop->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (loop->epoll_fd < 0 || loop->signal_fd < 0 || loop->timer_fd < 0 ||
+        timerfd_settime(loop->timer_fd, 0, &period, NULL) < 0) {
+        event_loop_close(loop);
+        return -1;
+    }
+
+    struct epoll_event ev = { .events = EPOLLIN };
+    ev.data.fd = loop->signal_fd;
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->signal_fd, &ev) < 0) { event_loop_close(loop); return -1; }
+    ev.data.fd = loop->timer_fd;
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->timer_fd, &ev) < 0) { event_loop_close(loop); return -1; }
+    return 0;
+}
+
+/**
+ * @brief Handles the signals that arrived, without waiting.
+ * Runs that never wait for a frame (benchmarks) call this every frame, since
+ * the blocked signals would otherwise never stop them.
+ */
+void event_loop_poll_signals(EventLoop* loop) {
+    struct signalfd_siginfo info;
+    while (read(loop->signal_fd, &info, sizeof(info)) == sizeof(info)) {
+        if (info.ssi_signo == SIGWINCH) terminal_resized = 1;
+        else running = 0; // SIGINT or SIGTERM
+    }
+}
+
+/**
+ * @brief Blocks until the frame timer fires or a signal asks the program to stop.
+ * Missed ticks (after a slow frame) are folded into one, so the loop never
+ * tries to catch up by rendering several frames back to back.
+ */
+void event_loop_wait_frame(EventLoop* loop) {
+    struct epoll_event events[2]; // The timer and the signals
+    while (running) {
+        int n = epoll_wait(loop->epoll_fd, events, 2, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            running = 0;
+            return;
+        }
+
+        int frame_due = 0;
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == loop->timer_fd) {
+                uint64_t expirations;
+                if (read(fd, &expirations, sizeof(expirations)) == sizeof(expirations)) frame_due = 1;
+            } else if (fd == loop->signal_fd) {
+                event_loop_poll_signals(loop);
+            }
+        }
+        if (frame_due) return;
+    }
+}
+#else
+void handle_sigint(int sig) {
+    (void)sig; // Unused parameter
+    running = 0;
+}
+
+void handle_sigwinch(int sig) {
+    (void)sig; // Unused parameter
+    terminal_resized = 1;
+}
+
+int event_loop_init(EventLoop* loop) {
+    // Setup for Graceful Exit
+    signal(SIGINT, handle_sigint);
+    signal(SIGTERM, handle_sigint);
+#ifndef _WIN32
+    signal(SIGWINCH, handle_sigwinch);
+#endif
+    loop->next_frame_ms = get_time_ms() + 1000.0 / TARGET_FPS;
+    return 0;
+}
+
+void event_loop_close(EventLoop* loop) {
+    (void)loop; // Nothing to release
+}
+
+void event_loop_poll_signals(EventLoop* loop) {
+    (void)loop; // The signal handlers already set the flags
+}
+
+void event_loop_wait_frame(EventLoop* loop) {
+    double remaining_ms = loop->next_frame_ms - get_time_ms();
+    if (remaining_ms > 0) {
+#ifdef _WIN32
+        Sleep((DWORD)remaining_ms);
+#else
+        struct timespec sleep_time;
+        long remainder_ns = (long)(remaining_ms * 1000000.0);
+        sleep_time.tv_sec = remainder_ns / 1000000000L;
+        sleep_time.tv_nsec = remainder_ns % 1000000000L;
+        nanosleep(&sleep_time, NULL);
+#endif
+    }
+    // Schedule from the deadline, but don't try to catch up after a slow frame
+    double now = get_time_ms();
+    loop->next_frame_ms += 1000.0 / TARGET_FPS;
+    if (loop->next_frame_ms < now) loop->next_frame_ms = now + 1000.0 / TARGET_FPS;
+}
+#endif
+
+
+// --- Memory Arena ---
+
+/**
+ * @brief Releases the arena's block.
+ */
+void arena_free(Arena* arena) {
+    if (arena->base) {
+#ifdef _WIN32
+        _aligned_free(arena->base);
+#else
+        if (arena->mapped) munmap(arena->base, arena->capacity);
+        else free(arena->base);
+#endif
+    }
+    arena->base = NULL;
+    arena->capacity = arena->used = 0;
+    arena->mapped = 0;
+}
+
+/**
+ * @brief Makes sure the arena can hold at least `size` bytes and empties it.
+ * The block is only replaced when it is too small; its contents are discarded
+ * either way. Large blocks are mapped directly and, where the OS supports it,
+ * advised to use transparent huge pages to save TLB misses on big canvases;
+ * if the mapping fails they fall back to the aligned allocator.
+ * @return 1 on success, 0 if the memory could not be allocated.
+ */
+int arena_reserve(Arena* arena, size_t size) {
+    size = arena_align(size > 0 ? size : 1);
+    if (size > arena->capacity) {
+        arena_free(arena);
+#ifdef _WIN32
+        arena->base = _aligned_malloc(size, ARENA_ALIGNMENT);
+#else
+        void* block = NULL;
+        if (size >= ARENA_HUGE_PAGE_SIZE) {
+            size = (size + ARENA_HUGE_PAGE_SIZE - 1) & ~(size_t)(ARENA_HUGE_PAGE_SIZE - 1);
+            block = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (block == MAP_FAILED) {
+                block = NULL;
+            } else {
+#ifdef MADV_HUGEPAGE
+                madvise(block, size, MADV_HUGEPAGE);
+#endif
+                arena->mapped = 1;
+            }
+        }
+        // Small blocks, and large ones the kernel wouldn't map, come from the aligned allocator
+        if (!block && posix_memalign(&block, ARENA_ALIGNMENT, size) != 0) block = NULL;
+        arena->base = block;
+#endif
+        if (!arena->base) return 0;
+        arena->capacity = size;
+    }
+    arena->used = 0;
+    return 1;
+}
+
+/**
+ * @brief Carves an aligned block out of the arena.
+ * @return The block, or NULL if the arena is exhausted.
+ */
+void* arena_alloc(Arena* arena, size_t size) {
+    size = arena_align(size);
+    if (arena->capacity - arena->used < size) return NULL;
+    void* block = arena->base + arena->used;
+    arena->used += size;
+    return block;
+}
@@ -0,0 +1,86 @@
+/**
+ * platform.h - Signals, timing, event loop and memory arena
+ *
+ * Copyright (c) 2025 Olivier Coz
+ *
+ * This software is released under the MIT License.
+ * See the LICENSE file for details.
+ */
+
+#ifndef HOLO_PLATFORM_H
+#define HOLO_PLATFORM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// On Linux the frame loop sleeps in epoll_wait(); elsewhere it falls back to signal handlers and sleeping
+#ifdef __linux__
+#define HAVE_EPOLL_LOOP 1
+#endif
+
+#define TARGET_FPS 30 // Desired frames per second for the animation
+
+// Renderer memory arena
+#define ARENA_ALIGNMENT         64                  // Cache line size, and enough for any SIMD load
+#define ARENA_HUGE_PAGE_SIZE    (2u * 1024 * 1024)  // Arenas at least this large are backed by huge pages
+#define ARENA_GROWTH_SLACK      4                   // Grow by an extra 1/4 so small growth reuses the block
+
+
+// --- Globals for Signal Handling ---
+extern volatile int running;
+extern volatile int terminal_resized;
+
+void get_terminal_size(int* width, int* height);
+double get_time_ms(void);
+
+
+// --- Event Loop ---
+
+/**
+ * @brief Waits for the next frame deadline while dispatching signals.
+ * On Linux the process sleeps in epoll_wait() on a timerfd ticking at
+ * TARGET_FPS and a signalfd for SIGINT/SIGTERM/SIGWINCH, so it wakes
+ * exactly when there is work. Elsewhere, classic signal
+ * handlers set the flags and the loop sleeps until the next deadline.
+ */
+typedef struct {
+#ifdef HAVE_EPOLL_LOOP
+    int epoll_fd, signal_fd, timer_fd;
+#else
+    double next_frame_ms; // Deadline of the next frame
+#endif
+} EventLoop;
+
+int event_loop_init(EventLoop* loop);
+void event_loop_poll_signals(EventLoop* loop);
+void event_loop_wait_frame(EventLoop* loop);
+void event_loop_close(EventLoop* loop);
+
+
+// --- Memory Arena ---
+
+/**
+ * @brief A bump allocator owning one block of renderer memory.
+ * All per-size buffers are carved out of a single block, so a resize is one
+ * allocation and the render loop never calls into the C allocator. Every
+ * allocation is aligned to ARENA_ALIGNMENT.
+ */
+typedef struct {
+    unsigned char* base;
+    size_t capacity;
+    size_t used;
+    int    mapped; // base came from mmap() rather than the aligned C allocator
+} Arena;
+
+/**
+ * @brief Rounds a size up to the arena alignment.
+ */
+static inline size_t arena_align(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+void arena_free(Arena* arena);
+int arena_reserve(Arena* arena, size_t size);
+void* arena_alloc(Arena* arena, size_t size);
+
+#endif // HOLO_PLATFORM_H
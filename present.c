@@ -0,0 +1,481 @@
+/**
+ * present.c - Terminal output: capability detection, diff encoding and pacing
+ *
+ * Copyright (c) 2025 Olivier Coz
+ *
+ * This software is released under the MIT License.
+ * See the LICENSE file for details.
+ */
+
+#include "present.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <termios.h> // For querying terminal capabilities in raw mode
+#include <poll.h>
+#endif
+
+#define TERMINAL_QUERY_TIMEOUT_MS 200 // Give up on capability replies after this long
+#define OUTPUT_BURST_SECONDS 0.25 // Output budget that may accumulate while frames are small
+#define OUTPUT_CHUNK_BYTES 512 // Largest single write once the terminal reports room, so it can't block for long
+
+
+// --- Terminal Presentation ---
+
+/**
+ * @brief Hashes one row of the character buffer, eight bytes at a time.
+ */
+uint64_t hash_row(const char* row, int len) {
+    uint64_t h = 0xcbf29ce484222325ULL ^ (uint64_t)len;
+    int i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, row + i, sizeof(word));
+        h = (h ^ word) * 0x100000001b3ULL;
+        h ^= h >> 29;
+    }
+    for (; i < len; i++) h = (h ^ (unsigned char)row[i]) * 0x100000001b3ULL;
+    return h;
+}
+
+/**
+ * @brief Checks whether a complete primary device attributes reply ("\x1b[?...c") was read.
+ */
+static int has_device_attributes_reply(const char* reply) {
+    for (const char* p = strstr(reply, "\x1b[?"); p; p = strstr(p + 1, "\x1b[?")) {
+        const char* end = p + 3 + strspn(p + 3, "0123456789;");
+        if (*end == 'c') return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Asks the terminal whether it supports synchronized output (DEC mode 2026).
+ * Sends a DECRQM query for mode 2026 followed by a primary device attributes
+ * request, which every terminal answers. If the DA reply arrives without a
+ * mode report before it, the mode is unsupported, so there is no need to wait
+ * for a timeout on terminals that ignore DECRQM.
+ * @return 1 if the mode is supported, 0 otherwise.
+ */
+int terminal_supports_sync_output(void) {
+#ifdef _WIN32
+    return 0;
+#else
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO)) return 0;
+    // Changing terminal modes from a background process group would stop us with SIGTTOU
+    if (tcgetpgrp(STDIN_FILENO) != getpgrp()) return 0;
+
+    struct termios saved, raw;
+    if (tcgetattr(STDIN_FILENO, &saved) < 0) return 0;
+    raw = saved;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) < 0) return 0;
+
+    static const char query[] = "\x1b[?2026$p\x1b[c";
+    int supported = 0;
+    if (write(STDOUT_FILENO, query, sizeof(query) - 1) == (ssize_t)(sizeof(query) - 1)) {
+        char reply[128];
+        size_t len = 0;
+        double deadline_ms = get_time_ms() + TERMINAL_QUERY_TIMEOUT_MS;
+        while (len < sizeof(reply) - 1) {
+            int timeout_ms = (int)(deadline_ms - get_time_ms());
+            struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+            if (timeout_ms <= 0 || poll(&pfd, 1, timeout_ms) <= 0) break;
+            ssize_t n = read(STDIN_FILENO, reply + len, sizeof(reply) - 1 - len);
+            if (n <= 0) break;
+            len += n;
+            reply[len] = '\0';
+            // The DA reply comes last, so once it is here we have everything
+            if (has_device_attributes_reply(reply)) break;
+        }
+        reply[len] = '\0';
+        int mode_state;
+        char* report = strstr(reply, "\x1b[?2026;");
+        if (report && sscanf(report, "\x1b[?2026;%d$y", &mode_state) == 1) {
+            supported = (mode_state == 1 || mode_state == 2); // Set or reset, but recognized
+        }
+    }
+    tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    return supported;
+#endif
+}
+
+/**
+ * @brief Writes as much pending output as the terminal accepts without blocking.
+ * @return 1 once everything has been written, 0 if the terminal is still busy.
+ */
+static int presenter_flush(Presenter* presenter) {
+#ifdef _WIN32
+    fwrite(presenter->out + presenter->out_sent, 1, presenter->out_len - presenter->out_sent, stdout);
+    fflush(stdout);
+    presenter->out_sent = presenter->out_len;
+#else
+    while (presenter->out_sent < presenter->out_len) {
+        size_t len = presenter->out_len - presenter->out_sent;
+        if (presenter->nonblocking) {
+            struct pollfd pfd = { .fd = STDOUT_FILENO, .events = POLLOUT };
+            int ready = poll(&pfd, 1, 0);
+            if (ready < 0 && errno == EINTR) continue;
+            if (ready == 0) return 0;
+            if (ready < 0 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
+                presenter->out_sent = presenter->out_len; // The terminal is gone; nothing left to wait for
+                break;
+            }
+            if (len > OUTPUT_CHUNK_BYTES) len = OUTPUT_CHUNK_BYTES;
+        }
+        ssize_t n = write(STDOUT_FILENO, presenter->out + presenter->out_sent, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            presenter->out_sent = presenter->out_len;
+            break;
+        }
+        presenter->out_sent += n;
+    }
+#endif
+    return 1;
+}
+
+/**
+ * @brief Waits until all pending output has been written.
+ * Needed before the output buffer is reused or the terminal is restored, so
+ * the terminal never stays in the middle of an escape sequence.
+ */
+void presenter_drain(Presenter* presenter) {
+    while (!presenter_flush(presenter)) {
+#ifndef _WIN32
+        struct pollfd pfd = { .fd = STDOUT_FILENO, .events = POLLOUT };
+        poll(&pfd, 1, -1);
+#endif
+    }
+}
+
+/**
+ * @brief Prepares the terminal for drawing frames.
+ * Interactive terminals get the alternate screen, so the animation doesn't
+ * end up in the scrollback and the original screen comes back on exit.
+ * Output to a terminal is only written while poll() reports room for it, so
+ * a slow link drops frames instead of stalling the render loop. The
+ * descriptor itself stays blocking: O_NONBLOCK would be shared with the shell
+ * and every other process on the terminal, and would outlive a crash.
+ * @param rate_limit Output budget in bytes per second, or 0 for unlimited.
+ */
+void presenter_init(Presenter* presenter, double rate_limit) {
+    presenter->front = presenter->out = NULL;
+    presenter->row_hashes = NULL;
+    presenter->cols = presenter->rows = 0;
+    presenter->out_len = presenter->out_sent = 0;
+    presenter->full_repaint = 1;
+    presenter->rate_limit = rate_limit;
+    presenter->budget = rate_limit * OUTPUT_BURST_SECONDS;
+    presenter->last_refill_ms = get_time_ms();
+    presenter->frames_dropped = 0;
+    presenter->nonblocking = 0;
+    presenter->alt_screen = isatty(STDOUT_FILENO);
+    presenter->sync_output = presenter->alt_screen && terminal_supports_sync_output();
+    if (presenter->alt_screen) {
+        printf("\x1b[?1049h\x1b[?25l"); // Switch to the (cleared) alternate screen and hide the cursor
+    } else {
+        printf("\x1b[?25l\x1b[2J"); // Hide cursor and clear screen
+    }
+    fflush(stdout);
+#ifndef _WIN32
+    presenter->nonblocking = presenter->alt_screen;
+#endif
+}
+
+/**
+ * @brief Restores the terminal to the state it was in before presenter_init.
+ */
+void presenter_shutdown(Presenter* presenter) {
+    presenter_drain(presenter);
+    if (presenter->alt_screen) {
+        printf("\x1b[?25h\x1b[?1049l"); // Show cursor again and return to the main screen
+    } else {
+        printf("\x1b[?25h\n"); // Show cursor again and move to a new line
+    }
+    fflush(stdout);
+}
+
+/**
+ * @brief Arena space presenter_resize needs for a screen of the given size.
+ */
+size_t presenter_arena_size(int cols, int rows) {
+    // A changed row never costs more than its text plus one cursor move and an erase
+    size_t out_capacity = (size_t)rows * (cols + 32) + 64;
+    return arena_align((size_t)cols * rows) + arena_align(rows * sizeof(uint64_t)) + arena_align(out_capacity);
+}
+
+/**
+ * @brief Carves the presenter's buffers for a new screen size out of the arena.
+ * The next frame is written in full since the screen contents are unknown.
+ */
+void presenter_resize(Presenter* presenter, Arena* arena, int cols, int rows) {
+    presenter->front = arena_alloc(arena, (size_t)cols * rows);
+    presenter->row_hashes = arena_alloc(arena, rows * sizeof(uint64_t));
+    presenter->out = arena_alloc(arena, (size_t)rows * (cols + 32) + 64);
+    presenter->cols = cols;
+    presenter->rows = rows;
+    presenter->full_repaint = 1;
+}
+
+static void out_append(Presenter* presenter, const char* bytes, size_t len) {
+    memcpy(presenter->out + presenter->out_len, bytes, len);
+    presenter->out_len += len;
+}
+
+static void out_number(Presenter* presenter, int value) {
+    char digits[12];
+    int n = 0;
+    do { digits[n++] = '0' + value % 10; value /= 10; } while (value > 0);
+    while (n > 0) presenter->out[presenter->out_len++] = digits[--n];
+}
+
+static int count_digits(int value) {
+    int n = 1;
+    while (value >= 10) { value /= 10; n++; }
+    return n;
+}
+
+/**
+ * @brief Moves the terminal cursor to (x, y) using the cheapest sequence.
+ * Candidates are an absolute jump (CUP), a forward skip on the same row (CUF)
+ * and a carriage return plus line feed when the target is on the next row.
+ */
+static void encode_move(Presenter* presenter, int x, int y) {
+    if (presenter->cursor_y == y && presenter->cursor_x == x) return;
+
+    int cup_cost = (x == 0) ? 3 + count_digits(y + 1) : 4 + count_digits(y + 1) + count_digits(x + 1);
+    int cuf_cost = (x > 0) ? 3 + count_digits(x) : 0;
+    if (presenter->cursor_y == y && presenter->cursor_x >= 0 && presenter->cursor_x < x &&
+        3 + count_digits(x - presenter->cursor_x) < cup_cost) {
+        out_append(presenter, "\x1b[", 2);
+        out_number(presenter, x - presenter->cursor_x);
+        out_append(presenter, "C", 1);
+    } else if (presenter->cursor_y == y - 1 && presenter->cursor_x >= 0 && 2 + cuf_cost < cup_cost) {
+        out_append(presenter, "\r\n", 2);
+        if (x > 0) {
+            out_append(presenter, "\x1b[", 2);
+            out_number(presenter, x);
+            out_append(presenter, "C", 1);
+        }
+    } else {
+        out_append(presenter, "\x1b[", 2);
+        out_number(presenter, y + 1);
+        if (x > 0) {
+            out_append(presenter, ";", 1);
+            out_number(presenter, x + 1);
+        }
+        out_append(presenter, "H", 1);
+    }
+    presenter->cursor_x = x;
+    presenter->cursor_y = y;
+}
+
+/**
+ * @brief Encodes the changes between the on-screen row and its new contents.
+ * Runs of unchanged cells are either skipped with a cursor-forward escape or
+ * simply reprinted, whichever is fewer bytes, and a tail that became blank is
+ * cleared with erase-in-line instead of being overwritten with spaces. This is
+ * the same byte-cost trade-off curses makes, without linking curses.
+ * @param known Whether `old_row` reflects the screen; if not, the row is written out.
+ */
+static void encode_row(Presenter* presenter, const char* new_row, const char* old_row, int y, int known) {
+    const int cols = presenter->cols;
+
+    // Columns [0, new_end) hold the row's text; everything from new_end on is blank
+    int new_end = cols;
+    while (new_end > 0 && new_row[new_end - 1] == ' ') new_end--;
+
+    int first = 0, last = cols - 1; // First and last columns that differ
+    if (known) {
+        while (first < cols && new_row[first] == old_row[first]) first++;
+        if (first == cols) return;
+        while (new_row[last] == old_row[last]) last--;
+    }
+
+    int x = first;
+    if (x < new_end) {
+        encode_move(presenter, x, y);
+        int end = (last < new_end) ? last + 1 : new_end;
+        while (x < end) {
+            if (known && new_row[x] == old_row[x]) {
+                int run = 1;
+                while (x + run < end && new_row[x + run] == old_row[x + run]) run++;
+                if (3 + count_digits(run) < run) {
+                    out_append(presenter, "\x1b[", 2);
+                    out_number(presenter, run);
+                    out_append(presenter, "C", 1);
+                } else {
+                    out_append(presenter, new_row + x, run);
+                }
+                x += run;
+            } else {
+                int run = 1;
+                while (x + run < end && !(known && new_row[x + run] == old_row[x + run])) run++;
+                out_append(presenter, new_row + x, run);
+                x += run;
+            }
+        }
+        // A write to the last column leaves the cursor in a pending-wrap state
+        presenter->cursor_x = (x < cols) ? x : -1;
+        presenter->cursor_y = y;
+    }
+
+    if (last >= new_end) {
+        // The blank tail changed: clear it, or print the few spaces if that's shorter
+        int start = (x > new_end) ? x : new_end;
+        if (last - start + 1 < 3) {
+            encode_move(presenter, start, y);
+            for (int i = start; i <= last; i++) out_append(presenter, " ", 1);
+            presenter->cursor_x = (last + 1 < cols) ? last + 1 : -1;
+        } else {
+            encode_move(presenter, start, y);
+            out_append(presenter, "\x1b[K", 3);
+        }
+    }
+}
+
+/**
+ * @brief Encodes a frame as the minimal update of what the terminal shows.
+ * Rows whose hash matches the previous frame are skipped outright; the others
+ * are diffed cell by cell. The result is left in presenter->out.
+ * With synchronized output the terminal holds back rendering until the whole
+ * frame has arrived, so it never shows a half-updated screen.
+ */
+void encode_frame(Presenter* presenter, const char* bbuffer) {
+    const int cols = presenter->cols;
+    const int known = !presenter->full_repaint;
+    presenter->out_len = 0;
+    presenter->cursor_x = presenter->cursor_y = -1;
+
+    if (presenter->sync_output) out_append(presenter, "\x1b[?2026h", 8);
+    for (int y = 0; y < presenter->rows; y++) {
+        const char* row = bbuffer + (size_t)y * cols;
+        char* front_row = presenter->front + (size_t)y * cols;
+        uint64_t hash = hash_row(row, cols);
+        if (known && hash == presenter->row_hashes[y]) continue;
+        presenter->row_hashes[y] = hash;
+        encode_row(presenter, row, front_row, y, known);
+        memcpy(front_row, row, cols);
+    }
+    if (presenter->full_repaint) {
+        // Every row was rewritten; only leftovers below the frame need erasing
+        encode_move(presenter, 0, presenter->rows);
+        out_append(presenter, "\x1b[J", 3);
+        presenter->full_repaint = 0;
+    }
+    if (presenter->sync_output) out_append(presenter, "\x1b[?2026l", 8);
+}
+
+/**
+ * @brief Encodes a frame and starts writing it to the terminal.
+ * If the previous frame hasn't fully drained yet, or the byte budget is spent,
+ * the frame is dropped rather than queued, so latency stays bounded on slow
+ * links. Since the diff is always taken against the last frame that was sent,
+ * the next frame that goes out also carries the changes of the dropped ones.
+ * @return 1 if the frame was sent, 0 if it was dropped.
+ */
+int present_frame(Presenter* presenter, const char* bbuffer) {
+    if (presenter->rate_limit > 0) {
+        double now = get_time_ms();
+        presenter->budget += presenter->rate_limit * (now - presenter->last_refill_ms) / 1000.0;
+        presenter->budget = fmin(presenter->budget, presenter->rate_limit * OUTPUT_BURST_SECONDS);
+        presenter->last_refill_ms = now;
+    }
+    if (!presenter_flush(presenter) || (presenter->rate_limit > 0 && presenter->budget < 0)) {
+        presenter->frames_dropped++;
+        return 0;
+    }
+
+    encode_frame(presenter, bbuffer);
+    presenter->out_sent = 0;
+    presenter->budget -= presenter->out_len;
+    presenter_flush(presenter);
+    return 1;
+}
+
+
+// --- Presenter Thread ---
+
+#ifdef HAVE_PRESENTER_THREAD
+static void* presenter_thread_main(void* arg) {
+    PresenterThread* pt = arg;
+    for (;;) {
+        pthread_mutex_lock(&pt->lock);
+        while (!pt->quit && atomic_load_explicit(&pt->ring->published, memory_order_acquire) == pt->frame) {
+            pthread_cond_wait(&pt->wake, &pt->lock);
+        }
+        int quit = pt->quit;
+        pthread_mutex_unlock(&pt->lock);
+        if (quit) return NULL;
+
+        if (frame_ring_latest(pt->ring, pt->cells, &pt->frame)) present_frame(pt->presenter, pt->cells);
+    }
+}
+#endif
+
+/**
+ * @brief Starts presenting the frames published to `ring`.
+ * The presenter and the ring belong to the thread until presenter_thread_stop;
+ * the caller only publishes and notifies meanwhile.
+ * @param cells Buffer of the ring's cols * rows for the thread's copy of a frame.
+ * @return 1 on success, 0 if the thread could not be created.
+ */
+int presenter_thread_start(PresenterThread* pt, Presenter* presenter, FrameRing* ring, char* cells) {
+    pt->presenter = presenter;
+    pt->ring = ring;
+    pt->cells = cells;
+    pt->frame = 0;
+#ifdef HAVE_PRESENTER_THREAD
+    pt->quit = 0;
+    pthread_mutex_init(&pt->lock, NULL);
+    pthread_cond_init(&pt->wake, NULL);
+    pt->started = pthread_create(&pt->thread, NULL, presenter_thread_main, pt) == 0;
+    if (!pt->started) {
+        pthread_cond_destroy(&pt->wake);
+        pthread_mutex_destroy(&pt->lock);
+        return 0;
+    }
+#endif
+    return 1;
+}
+
+/**
+ * @brief Tells the presenter a new frame was published. Never waits for it to be presented.
+ */
+void presenter_thread_notify(PresenterThread* pt) {
+#ifdef HAVE_PRESENTER_THREAD
+    // Signaled under the lock, so the thread can't miss it between its check and its wait
+    pthread_mutex_lock(&pt->lock);
+    pthread_cond_signal(&pt->wake);
+    pthread_mutex_unlock(&pt->lock);
+#else
+    if (frame_ring_latest(pt->ring, pt->cells, &pt->frame)) present_frame(pt->presenter, pt->cells);
+#endif
+}
+
+/**
+ * @brief Stops and joins the thread, handing the presenter back to the caller.
+ * Output still pending is left for presenter_drain. Safe to call when the
+ * thread was never started.
+ */
+void presenter_thread_stop(PresenterThread* pt) {
+#ifdef HAVE_PRESENTER_THREAD
+    if (!pt->started) return;
+    pthread_mutex_lock(&pt->lock);
+    pt->quit = 1;
+    pthread_cond_signal(&pt->wake);
+    pthread_mutex_unlock(&pt->lock);
+    pthread_join(pt->thread, NULL);
+    pthread_cond_destroy(&pt->wake);
+    pthread_mutex_destroy(&pt->lock);
+    pt->started = 0;
+#endif
+}
@@ -0,0 +1,88 @@
+/**
+ * present.h - Terminal output: capability detection, diff encoding and pacing
+ *
+ * Copyright (c) 2025 Olivier Coz
+ *
+ * This software is released under the MIT License.
+ * See the LICENSE file for details.
+ */
+
+#ifndef HOLO_PRESENT_H
+#define HOLO_PRESENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "platform.h"
+#include "frames.h"
+
+// The terminal is written from its own thread where POSIX threads exist; on Windows from the render loop
+#ifndef _WIN32
+#define HAVE_PRESENTER_THREAD 1
+#include <pthread.h>
+#endif
+
+/**
+ * @brief Terminal output state shared across frames.
+ */
+typedef struct {
+    int alt_screen;  // Frames are drawn on the alternate screen buffer
+    int sync_output; // The terminal supports synchronized output (DEC mode 2026)
+
+    // What the terminal currently shows, so only the differences are sent
+    char* front;          // Characters on screen, cols * rows
+    uint64_t* row_hashes; // Hash of every row as last written, to skip unchanged rows quickly
+    int cols, rows;
+    int full_repaint;     // Screen contents are unknown (startup or resize): write every row
+
+    // Encoded escape sequences and text for the current frame
+    char* out;
+    size_t out_len;
+    size_t out_sent;        // Bytes of `out` the terminal has accepted so far
+    int cursor_x, cursor_y; // Where the terminal cursor is while encoding; -1 if unknown
+
+    // Output pacing for slow links
+    int    nonblocking;    // Writes wait for the terminal to be writable instead of blocking
+    double rate_limit;     // Output budget in bytes per second; 0 for unlimited
+    double budget;         // Bytes that may still be sent, refilled over time
+    double last_refill_ms;
+    unsigned long frames_dropped;
+} Presenter;
+
+uint64_t hash_row(const char* row, int len);
+int terminal_supports_sync_output(void);
+
+void presenter_init(Presenter* presenter, double rate_limit);
+void presenter_shutdown(Presenter* presenter);
+void presenter_drain(Presenter* presenter);
+size_t presenter_arena_size(int cols, int rows);
+void presenter_resize(Presenter* presenter, Arena* arena, int cols, int rows);
+
+void encode_frame(Presenter* presenter, const char* bbuffer);
+int present_frame(Presenter* presenter, const char* bbuffer);
+
+/**
+ * @brief A Presenter fed from a FrameRing on a thread of its own.
+ * The renderer publishes every finished frame and calls presenter_thread_notify;
+ * the thread copies out the latest frame and encodes and writes it while the
+ * next one is being drawn. Frames published while it is still busy are skipped.
+ * Without thread support, presenter_thread_notify presents on the caller.
+ */
+typedef struct {
+    Presenter* presenter;
+    FrameRing* ring;
+    char* cells;    // The thread's copy of the latest frame, cols * rows
+    uint64_t frame; // Number of that frame in the ring
+#ifdef HAVE_PRESENTER_THREAD
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t  wake; // Signaled when a frame is published or the thread has to stop
+    int quit;
+    int started;
+#endif
+} PresenterThread;
+
+int presenter_thread_start(PresenterThread* pt, Presenter* presenter, FrameRing* ring, char* cells);
+void presenter_thread_notify(PresenterThread* pt);
+void presenter_thread_stop(PresenterThread* pt);
+
+#endif // HOLO_PRESENT_H
@@ -0,0 +1,857 @@
+/**
+ * render.c - Point sampling, projection and Z-buffering of glyph segments
+ *
+ * Copyright (c) 2025 Olivier Coz
+ *
+ * This software is released under the MIT License.
+ * See the LICENSE file for details.
+ */
+
+#include "render.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifdef HOLO_FAST_RCP
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#endif
+
+// Minimum projected segment size (in rows) for each level, and its step multiplier
+static const float lod_min_rows[LOD_LEVELS]   = { 2.0f, 1.0f, 0.0f };
+static const float lod_step_scale[LOD_LEVELS] = { 1.0f, 2.0f, 4.0f };
+
+
+// --- Core Rendering Functions ---
+
+/**
+ * @brief Returns 1/x for the perspective divide.
+ * With HOLO_FAST_RCP the hardware reciprocal estimate (about 12 bits) is
+ * refined with one Newton-Raphson step to nearly full float precision, which
+ * is plenty for depths that stay within a few units of CAMERA_DISTANCE and
+ * cheaper than a division. Otherwise, and on targets without an estimate
+ * instruction, it is a plain division.
+ */
+static inline float reciprocal(float x) {
+#if defined(HOLO_FAST_RCP) && (defined(__SSE__) || defined(_M_X64))
+    float r = _mm_cvtss_f32(_mm_rcp_ss(_mm_set_ss(x)));
+    return r * (2.0f - x * r);
+#elif defined(HOLO_FAST_RCP) && defined(__ARM_NEON)
+    float32x2_t v = vdup_n_f32(x);
+    float32x2_t r = vrecpe_f32(v);
+    r = vmul_f32(r, vrecps_f32(v, r));
+    return vget_lane_f32(r, 0);
+#else
+    return 1.0f / x;
+#endif
+}
+
+/**
+ * @brief Lights a surface normal and picks its character from the palette.
+ * @param light The light direction in the normal's space (RenderContext or GlyphTransform).
+ */
+static inline char shade_char(float nx, float ny, float nz, const float light[3], const RenderContext* ctx) {
+    // Simple dot product for luminance; the light was turned into object space instead of the normal into camera space
+    float L = nx * light[0] + ny * light[1] + nz * light[2];
+
+    int palette_idx = (int)(L * ctx->contrast);
+    palette_idx = palette_idx < 0 ? 0 : (palette_idx >= ctx->palette_len ? ctx->palette_len - 1 : palette_idx); // Clamp
+    return ctx->palette[palette_idx];
+}
+
+/**
+ * @brief Z-tests a projected point against its cell and shades the cell if the point is nearer.
+ */
+static inline void shade_cell(int buffer_idx, float ooz, float nx, float ny, float nz, const float light[3],
+                              const RenderContext* ctx) {
+    if (ooz <= ctx->zbuffer[buffer_idx]) return;
+    ctx->zbuffer[buffer_idx] = ooz;
+    ctx->bbuffer[buffer_idx] = shade_char(nx, ny, nz, light, ctx);
+    if (ctx->obuffer) ctx->obuffer[buffer_idx] = ctx->object;
+}
+
+
+// --- Tile Binning ---
+
+/**
+ * @brief Arena space tile_binner_resize needs for a screen of the given size.
+ */
+size_t tile_binner_arena_size(int sw, int sh) {
+    size_t num_tiles = (size_t)((sw + TILE_W - 1) / TILE_W) * ((sh + TILE_H - 1) / TILE_H);
+    return arena_align(num_tiles * TILE_BIN_CAPACITY * sizeof(BinnedPoint)) + arena_align(num_tiles * sizeof(int));
+}
+
+/**
+ * @brief Carves the bins for a new screen size out of the arena, all empty.
+ */
+void tile_binner_resize(TileBinner* binner, Arena* arena, int sw, int sh) {
+    binner->tiles_x = (sw + TILE_W - 1) / TILE_W;
+    binner->tiles_y = (sh + TILE_H - 1) / TILE_H;
+    size_t num_tiles = (size_t)binner->tiles_x * binner->tiles_y;
+    binner->bins = arena_alloc(arena, num_tiles * TILE_BIN_CAPACITY * sizeof(BinnedPoint));
+    binner->counts = arena_alloc(arena, num_tiles * sizeof(int));
+    memset(binner->counts, 0, num_tiles * sizeof(int));
+}
+
+/**
+ * @brief Z-tests binned points of the tile whose first cell is `origin`, in order.
+ */
+static inline void resolve_points(const RenderContext* ctx, int origin, const BinnedPoint* points, int count) {
+    for (int i = 0; i < count; i++) {
+        int cell = origin + (points[i].cell / TILE_W) * ctx->sw + points[i].cell % TILE_W;
+        if (points[i].depth > ctx->zbuffer[cell]) {
+            ctx->zbuffer[cell] = points[i].depth;
+            ctx->bbuffer[cell] = points[i].ch;
+            if (ctx->obuffer) ctx->obuffer[cell] = points[i].object;
+        }
+    }
+}
+
+/**
+ * @brief Z-tests the queued points of one tile, in the order they were drawn, and empties it.
+ */
+static void resolve_tile(const RenderContext* ctx, int tile) {
+    TileBinner* binner = ctx->binner;
+    const int origin = (tile / binner->tiles_x) * TILE_H * ctx->sw + (tile % binner->tiles_x) * TILE_W;
+    resolve_points(ctx, origin, &binner->bins[(size_t)tile * TILE_BIN_CAPACITY], binner->counts[tile]);
+    binner->counts[tile] = 0;
+}
+
+/**
+ * @brief Resolves every tile that still holds points.
+ * A cell's points all go through its tile in drawing order, so the frame is
+ * the same as without binning. Must run before the buffers are read, and
+ * before anything writes them directly.
+ */
+void tile_binner_flush(const RenderContext* ctx) {
+    TileBinner* binner = ctx->binner;
+    if (!binner) return;
+    const int num_tiles = binner->tiles_x * binner->tiles_y;
+    for (int tile = 0; tile < num_tiles; tile++) {
+        if (binner->counts[tile] > 0) resolve_tile(ctx, tile);
+    }
+}
+
+/**
+ * @brief Shades a projected point and queues it in its tile, resolving the tile when it is full.
+ * @param bin_slot The tile index times 256 plus the cell within the tile.
+ */
+static inline void bin_point(int bin_slot, float depth, char ch, const RenderContext* ctx) {
+    TileBinner* binner = ctx->binner;
+    const int tile = bin_slot >> 8;
+    if (binner->counts[tile] == TILE_BIN_CAPACITY) resolve_tile(ctx, tile);
+    binner->bins[(size_t)tile * TILE_BIN_CAPACITY + binner->counts[tile]++] =
+        (BinnedPoint){ depth, (unsigned char)bin_slot, ch, ctx->object };
+}
+
+
+// --- Segment Templates ---
+
+/**
+ * @brief Records one sample point, or only counts it when `out` is NULL.
+ */
+static inline void emit_point(SegmentPoint* out, int* count,
+                              float x, float y, float z, float nx, float ny, float nz) {
+    if (out) out[*count] = (SegmentPoint){ x, y, z, nx, ny, nz };
+    (*count)++;
+}
+
+/**
+ * @brief Samples the surface of a segment with flat faces and pointy ends.
+ * Points and normals are in segment-local space, centered on the segment.
+ * Coarser levels of detail drop the pointy ends (the flat faces grow to cover
+ * the joints instead) and sample with a larger step. The caps are left open
+ * over the pointy ends, so this is not the closed SegmentMesh that -x exports.
+ * @param out Receives the points; pass NULL to only count them.
+ * @return The number of points.
+ */
+static int sample_segment(float length, float seg_w, float seg_t, float point_len, float density, int lod,
+                          SegmentPoint* out)
+{
+    const float step = density * lod_step_scale[lod];
+    int count = 0;
+
+    if (lod == LOD_STROKE) {
+        // The segment is about a cell thick: one line through the middle of each face is enough
+        const float half_len = (length + point_len) / 2.0f;
+        for (int side = 1; side >= -1; side -= 2) {
+            for (float i = -half_len; i < half_len; i += step) emit_point(out, &count, i, side * seg_w / 2.0f, 0, 0, side, 0);
+            for (float i = -half_len; i < half_len; i += step) emit_point(out, &count, i, 0, side * seg_t / 2.0f, 0, 0, side);
+        }
+        return count;
+    }
+    if (lod == LOD_BOX) {
+        length += point_len; // Stretch the box over half of each pointy end to close the joints
+    }
+
+    // Every face is sampled on its own, so consecutive points are neighbours on
+    // screen and the runs landing in one cell can be collapsed when drawing.
+
+    // Top and bottom flat faces of the segment (normals point up and down in local Y)
+    for (int side = 1; side >= -1; side -= 2) {
+        for (float i = -length / 2.0f; i < length / 2.0f; i += step) {
+            for (float j = -seg_t / 2.0f; j < seg_t / 2.0f; j += step) {
+                emit_point(out, &count, i, side * seg_w / 2.0f, j, 0, side, 0);
+            }
+        }
+    }
+
+    // Front and back faces of the segment body (normals point out along local +Z and -Z)
+    for (int side = 1; side >= -1; side -= 2) {
+        for (float i = -length / 2.0f; i < length / 2.0f; i += step) {
+            for (float j = -seg_w / 2.0f; j < seg_w / 2.0f; j += step) {
+                emit_point(out, &count, i, j, side * seg_t / 2.0f, 0, 0, side);
+            }
+        }
+    }
+    if (lod != LOD_FULL) return count;
+
+    // The four triangular faces of the pointy ends
+    const float half_w = seg_w / 2.0f;
+    float nl = sqrtf(half_w * half_w + point_len * point_len); // Normal vector length
+    if (nl < 1e-5) return count; // Avoid division by zero
+    float cnx = half_w / nl;  // Normal X component for the slope
+    float cny = point_len / nl; // Normal Y component for the slope
+
+    for (int end = 1; end >= -1; end -= 2) {
+        for (int side = 1; side >= -1; side -= 2) {
+            for (float u = 0; u < point_len; u += density) {
+                float yp = half_w * (1.0f - u / point_len); // Y-position on the triangle slope
+                float px = end * (length / 2.0f + u);
+                for (float pz = -seg_t / 2.0f; pz < seg_t / 2.0f; pz += density) {
+                    emit_point(out, &count, px, side * yp, pz, end * cnx, side * cny, 0);
+                }
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Samples one point template per segment length class and level of detail.
+ * The 14 segments of the font only come in a few lengths (horizontal, outer
+ * and inner vertical, diagonal), and the sampled points only depend on the
+ * length, so segments of the same length share one template in segment-local
+ * space. The templates live in their own arena, which keeps its block when
+ * they are rebuilt for a new density.
+ * @param num_lods Levels of detail to build, starting from LOD_FULL.
+ * @return 1 on success, 0 if the memory could not be allocated.
+ */
+int segment_templates_build(SegmentTemplates* templates, const float segment_lengths[NUM_SEGMENTS],
+                            float seg_w, float seg_t, float point_len, float density, int num_lods)
+{
+    float* class_lengths = templates->class_lengths;
+    templates->num_classes = 0;
+    for (int i = 0; i < NUM_SEGMENTS; i++) {
+        int c = 0;
+        while (c < templates->num_classes && class_lengths[c] != segment_lengths[i]) c++;
+        if (c == templates->num_classes) class_lengths[templates->num_classes++] = segment_lengths[i];
+        templates->segment_class[i] = c;
+    }
+
+    // Count first, so the arena is sized once for every template
+    size_t bytes = 0;
+    int counts[NUM_SEGMENTS][LOD_LEVELS];
+    for (int c = 0; c < templates->num_classes; c++) {
+        for (int lod = 0; lod < num_lods; lod++) {
+            counts[c][lod] = sample_segment(class_lengths[c], seg_w, seg_t, point_len, density, lod, NULL);
+            bytes += arena_align(counts[c][lod] * sizeof(SegmentPoint));
+        }
+    }
+    templates->density = 0; // Invalid until every template is filled in
+    if (!arena_reserve(&templates->arena, bytes)) return 0;
+
+    for (int c = 0; c < templates->num_classes; c++) {
+        for (int lod = 0; lod < LOD_LEVELS; lod++) {
+            PointTemplate* tmpl = &templates->templates[c][lod];
+            if (lod >= num_lods) {
+                // Not built: fall back to the finest level that was
+                *tmpl = templates->templates[c][num_lods - 1];
+                continue;
+            }
+            SegmentPoint* points = arena_alloc(&templates->arena, counts[c][lod] * sizeof(SegmentPoint));
+            tmpl->count = sample_segment(class_lengths[c], seg_w, seg_t, point_len, density, lod, points);
+            tmpl->points = points;
+        }
+    }
+    templates->num_lods = num_lods;
+    templates->seg_w = seg_w;
+    templates->seg_t = seg_t;
+    templates->point_len = point_len;
+    templates->density = density;
+    return 1;
+}
+
+/**
+ * @brief Releases the memory of the point templates.
+ */
+void segment_templates_free(SegmentTemplates* templates) {
+    arena_free(&templates->arena);
+    templates->density = 0;
+}
+
+
+// --- Glyph Cache ---
+
+/**
+ * @brief Points of a glyph at one level of detail: all of its segments' points.
+ */
+static size_t glyph_point_bound(const SegmentTemplates* templates, uint16_t seg_data, int lod) {
+    size_t count = 0;
+    for (int i = 0; i < NUM_SEGMENTS; i++) {
+        if ((seg_data >> i) & 1) count += templates->templates[templates->segment_class[i]][lod].count;
+    }
+    return count;
+}
+
+/**
+ * @brief Arena space needed to compile a set of segments at every level of detail.
+ */
+static size_t points_arena_size(const SegmentTemplates* templates, uint16_t seg_data) {
+    size_t bytes = 0;
+    for (int lod = 0; lod < templates->num_lods; lod++) {
+        bytes += GLYPH_ARRAYS * arena_align(glyph_point_bound(templates, seg_data, lod) * sizeof(float));
+    }
+    return bytes;
+}
+
+/**
+ * @brief Instantiates a set of segments into one point set.
+ * Points are stored in character-local space, so drawing a glyph no longer
+ * rotates every point by its segment's transform. They stay in segment
+ * order, each segment's points in template order.
+ * @param out Receives the points at every level of detail, carved out of `arena`.
+ */
+static void compile_points(Arena* arena, const SegmentTemplates* templates, const SegmentDef seg_defs[NUM_SEGMENTS],
+                           uint16_t seg_data, GlyphPoints out_lods[LOD_LEVELS])
+{
+    for (int lod = 0; lod < LOD_LEVELS; lod++) {
+        GlyphPoints* out = &out_lods[lod];
+        if (lod >= templates->num_lods) {
+            *out = out_lods[templates->num_lods - 1];
+            continue;
+        }
+        const size_t stride = arena_align(glyph_point_bound(templates, seg_data, lod) * sizeof(float)) / sizeof(float);
+        float* block = arena_alloc(arena, GLYPH_ARRAYS * stride * sizeof(float));
+        float *x = block, *y = x + stride, *z = y + stride, *nx = z + stride, *ny = nx + stride, *nz = ny + stride;
+        int count = 0;
+        for (int i = 0; i < NUM_SEGMENTS; i++) {
+            if (!((seg_data >> i) & 1)) continue;
+            const SegmentDef* def = &seg_defs[i];
+            const PointTemplate* tmpl = &templates->templates[templates->segment_class[i]][lod];
+            for (int k = 0; k < tmpl->count; k++) {
+                // Rotated around Z into the segment's place in the character
+                const SegmentPoint* p = &tmpl->points[k];
+                x[count] = p->x * def->cos_ra - p->y * def->sin_ra + def->pos_x;
+                y[count] = p->x * def->sin_ra + p->y * def->cos_ra + def->pos_y;
+                z[count] = p->z;
+                nx[count] = p->nx * def->cos_ra - p->ny * def->sin_ra;
+                ny[count] = p->nx * def->sin_ra + p->ny * def->cos_ra;
+                nz[count] = p->nz;
+                count++;
+            }
+        }
+        *out = (GlyphPoints){ x, y, z, nx, ny, nz, count };
+    }
+}
+
+/**
+ * @brief Makes sure every glyph of `text` is compiled for the current templates.
+ * New glyphs are appended to the cache. When they don't fit, the cache starts
+ * over with room for the glyphs of this text only.
+ * @return 1 on success, 0 if the memory could not be allocated.
+ */
+int glyph_cache_prepare(GlyphCache* cache, const SegmentTemplates* templates, const SegmentDef seg_defs[NUM_SEGMENTS],
+                        const char* text)
+{
+    if (cache->density != templates->density) {
+        memset(cache->compiled, 0, sizeof(cache->compiled));
+        cache->arena.used = 0;
+        cache->density = templates->density;
+    }
+
+    unsigned char wanted[SUPPORTED_CHARS] = {0};
+    size_t missing_bytes = 0, text_bytes = 0;
+    for (const char* s = text; *s; s++) {
+        int glyph = (*s < ASCII_OFFSET || *s >= ASCII_OFFSET + SUPPORTED_CHARS) ? 0 : *s - ASCII_OFFSET;
+        if (wanted[glyph]) continue;
+        wanted[glyph] = 1;
+        size_t bytes = points_arena_size(templates, FourteenSegmentASCII[glyph]);
+        text_bytes += bytes;
+        if (!cache->compiled[glyph]) missing_bytes += bytes;
+    }
+    if (missing_bytes == 0) return 1;
+
+    if (cache->arena.capacity - cache->arena.used < missing_bytes) {
+        memset(cache->compiled, 0, sizeof(cache->compiled));
+        size_t reserve_bytes = text_bytes > cache->arena.capacity ? text_bytes + text_bytes / ARENA_GROWTH_SLACK : text_bytes;
+        if (!arena_reserve(&cache->arena, reserve_bytes)) {
+            cache->density = 0;
+            return 0;
+        }
+    }
+    for (int glyph = 0; glyph < SUPPORTED_CHARS; glyph++) {
+        if (wanted[glyph] && !cache->compiled[glyph]) {
+            compile_points(&cache->arena, templates, seg_defs, FourteenSegmentASCII[glyph], cache->glyphs[glyph]);
+            cache->compiled[glyph] = 1;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Makes sure the cache also holds every segment on its own, for glyphs drawn segment by segment.
+ * A changing character is drawn as separate segments so each can move on its
+ * own.
+ * @return 1 on success, 0 if the memory could not be allocated.
+ */
+int glyph_cache_prepare_segments(GlyphCache* cache, const SegmentTemplates* templates,
+                                 const SegmentDef seg_defs[NUM_SEGMENTS])
+{
+    if (cache->segment_density == templates->density) return 1;
+    size_t bytes = 0;
+    for (int i = 0; i < NUM_SEGMENTS; i++) bytes += points_arena_size(templates, 1u << i);
+    cache->segment_arena.used = 0;
+    if (!arena_reserve(&cache->segment_arena, bytes)) {
+        cache->segment_density = 0;
+        return 0;
+    }
+    for (int i = 0; i < NUM_SEGMENTS; i++) {
+        compile_points(&cache->segment_arena, templates, seg_defs, 1u << i, cache->segments[i]);
+    }
+    cache->segment_density = templates->density;
+    return 1;
+}
+
+/**
+ * @brief Releases the memory of the compiled glyphs.
+ */
+void glyph_cache_free(GlyphCache* cache) {
+    arena_free(&cache->arena);
+    arena_free(&cache->segment_arena);
+    memset(cache->compiled, 0, sizeof(cache->compiled));
+    cache->density = 0;
+    cache->segment_density = 0;
+}
+
+/**
+ * @brief Projects points [base, base + n) of a glyph without branches, so the loop can be vectorized.
+ * Each point goes through the glyph's transform and the perspective divide;
+ * points behind the camera or off-screen get cell -1 and a meaningless slot.
+ * When binning into tiles_x tiles per row, `slots` receives each point's tile
+ * and cell within the tile (see bin_point) and `shades` its palette index,
+ * since binned points are shaded before their Z-test. Both are NULL
+ * otherwise, and the call is inlined with that constant so the unbinned loop
+ * carries none of the extra work.
+ */
+static inline void project_batch(const GlyphPoints* glyph, int base, int n, const GlyphTransform* xf,
+                                 const RenderContext* ctx, int tiles_x, int* cells, float* depths,
+                                 int* slots, int* shades) {
+    const float half_w = ctx->sw / 2.0f, half_h = ctx->sh / 2.0f;
+    const float zoom_x = ctx->zoom * 2.0f, zoom_y = ctx->zoom;
+    const float (*m)[3] = xf->m;
+    const float m00 = m[0][0], m01 = m[0][1], m02 = m[0][2];
+    const float m10 = m[1][0], m11 = m[1][1], m12 = m[1][2];
+    const float m20 = m[2][0], m21 = m[2][1], m22 = m[2][2];
+    const float t_x = xf->t[0], t_y = xf->t[1], t_z = xf->t[2];
+    const int sw = ctx->sw, sh = ctx->sh;
+    const float *px = glyph->x + base, *py = glyph->y + base, *pz = glyph->z + base;
+
+    for (int k = 0; k < n; k++) {
+        float x = px[k], y = py[k], z = pz[k];
+        float rot_x   = m00 * x + m01 * y + m02 * z + t_x;
+        float final_y = m10 * x + m11 * y + m12 * z + t_y;
+        float final_z = m20 * x + m21 * y + m22 * z + t_z;
+        float ooz = reciprocal(final_z > 0 ? final_z : 1.0f);
+        int xp = (int)(half_w + zoom_x * rot_x * ooz);
+        int yp = (int)(half_h - zoom_y * final_y * ooz);
+        int visible = (final_z > 0) & (xp >= 0) & (xp < sw) & (yp >= 0) & (yp < sh);
+        cells[k] = visible ? xp + sw * yp : -1;
+        depths[k] = ooz;
+        // Unsigned, as off-screen points may have negative coordinates
+        if (slots) slots[k] = (int)((unsigned)((yp / TILE_H) * tiles_x + xp / TILE_W) << 8 | (unsigned)((yp % TILE_H) * TILE_W + xp % TILE_W));
+    }
+
+    if (shades) {
+        const int last_shade = (int)ctx->palette_len - 1;
+        const float light_x = xf->light[0], light_y = xf->light[1], light_z = xf->light[2], contrast = ctx->contrast;
+        const float *pnx = glyph->nx + base, *pny = glyph->ny + base, *pnz = glyph->nz + base;
+        for (int k = 0; k < n; k++) {
+            // Same lighting as shade_char
+            int shade = (int)((pnx[k] * light_x + pny[k] * light_y + pnz[k] * light_z) * contrast);
+            shades[k] = shade < 0 ? 0 : (shade > last_shade ? last_shade : shade);
+        }
+    }
+}
+
+/**
+ * @brief Collapses runs of consecutive points that land in the same cell to their nearest point.
+ * Ties keep the first point, as consecutive Z-tests would. Off-screen points
+ * are dropped.
+ * @param nearest Receives the index of every surviving point, in order.
+ * @return The number of survivors.
+ */
+static inline int collapse_runs(const int* cells, const float* depths, int n, int* nearest) {
+    int survivors = 0;
+    for (int k = 0; k < n;) {
+        const int cell = cells[k];
+        int best = k;
+        for (k++; k < n && cells[k] == cell; k++) {
+            if (depths[k] > depths[best]) best = k;
+        }
+        if (cell >= 0) nearest[survivors++] = best;
+    }
+    return survivors;
+}
+
+/**
+ * @brief Places a glyph: composes the object's transform with the glyph's own rotation and position.
+ * Built once per glyph and frame, so per-glyph motion costs nothing per point.
+ * @param local The glyph's rotation around its origin, in character-local space; NULL for none.
+ * @param x, y, z The glyph's origin in object space (for plain text, char_center_x, 0, 0).
+ */
+void glyph_transform(const RenderContext* ctx, const float local[3][3], float x, float y, float z, GlyphTransform* xf) {
+    const float (*m)[3] = ctx->transform;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            xf->m[i][j] = local ? m[i][0] * local[0][j] + m[i][1] * local[1][j] + m[i][2] * local[2][j] : m[i][j];
+        }
+        // The light goes back through the glyph's rotation, like it went through the object's
+        xf->light[i] = local ? local[0][i] * ctx->light[0] + local[1][i] * ctx->light[1] + local[2][i] * ctx->light[2]
+                             : ctx->light[i];
+    }
+    xf->t[0] = m[0][0] * x + m[0][1] * y + m[0][2] * z + ctx->offset_x;
+    xf->t[1] = m[1][0] * x + m[1][1] * y + m[1][2] * z + ctx->offset_y;
+    xf->t[2] = m[2][0] * x + m[2][1] * y + m[2][2] * z + ctx->offset_z + CAMERA_DISTANCE;
+}
+
+/**
+ * @brief Places one segment of a glyph: turns it by `local` and scales it by `scale` around its center.
+ * Used for segments that move apart from their glyph, such as the ones of a changing character.
+ * @param local The segment's rotation, in character-local space; NULL for none.
+ * @param cx, cy The segment's center in character-local space.
+ */
+void segment_transform(const GlyphTransform* glyph, const float local[3][3], float scale, float cx, float cy,
+                       GlyphTransform* xf)
+{
+    const float (*m)[3] = glyph->m;
+    float r[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) r[i][j] = local ? local[i][j] * scale : (i == j ? scale : 0.0f);
+    }
+    // The center stays put: points map to m * (r * (p - c) + c) + t
+    const float c[3] = { cx - (r[0][0] * cx + r[0][1] * cy), cy - (r[1][0] * cx + r[1][1] * cy), -(r[2][0] * cx + r[2][1] * cy) };
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) xf->m[i][j] = m[i][0] * r[0][j] + m[i][1] * r[1][j] + m[i][2] * r[2][j];
+        xf->t[i] = m[i][0] * c[0] + m[i][1] * c[1] + m[i][2] * c[2] + glyph->t[i];
+        // Scaling leaves the normals alone; only the rotation turns the light
+        xf->light[i] = local ? local[0][i] * glyph->light[0] + local[1][i] * glyph->light[1] + local[2][i] * glyph->light[2]
+                             : glyph->light[i];
+    }
+}
+
+/**
+ * @brief Draws a compiled glyph placed by `xf` (see glyph_transform).
+ * Points are projected in batches (project_batch) and collapsed to one per run
+ * of same-cell points (collapse_runs) before the Z-buffer is touched. Faces
+ * are sampled in order, so when the sampling is finer than the screen a run
+ * costs one buffer test instead of many. With a binner in the context the
+ * survivors are queued by tile instead, and tile_binner_flush writes them to
+ * the buffers.
+ */
+HOLO_TARGET_CLONES
+void draw_glyph(const GlyphPoints* glyph, const GlyphTransform* xf, const RenderContext* ctx) {
+    int cells[PROJECT_BATCH], slots[PROJECT_BATCH], shades[PROJECT_BATCH], nearest[PROJECT_BATCH];
+    float depths[PROJECT_BATCH];
+
+    for (int base = 0; base < glyph->count; base += PROJECT_BATCH) {
+        const int n = (glyph->count - base < PROJECT_BATCH) ? glyph->count - base : PROJECT_BATCH;
+        if (ctx->binner) project_batch(glyph, base, n, xf, ctx, ctx->binner->tiles_x, cells, depths, slots, shades);
+        else project_batch(glyph, base, n, xf, ctx, 0, cells, depths, NULL, NULL);
+
+        const int survivors = collapse_runs(cells, depths, n, nearest);
+        for (int j = 0; j < survivors; j++) {
+            const int k = nearest[j];
+            if (ctx->binner) {
+                bin_point(slots[k], depths[k], ctx->palette[shades[k]], ctx);
+            } else {
+                const int i = base + k;
+                shade_cell(cells[k], depths[k], glyph->nx[i], glyph->ny[i], glyph->nz[i], xf->light, ctx);
+            }
+        }
+    }
+}
+
+
+// --- Parallel Frames ---
+
+/**
+ * @brief Glyph job: projects one glyph and groups its surviving points by tile.
+ */
+HOLO_TARGET_CLONES
+static void glyph_job(void* data, int index, int worker) {
+    FrameJobs* frame = data;
+    const RenderContext* ctx = frame->contexts[index];
+    const GlyphPoints* glyph = frame->glyphs[index];
+    GlyphBins* bins = &frame->bins[index];
+    BinnedPoint* queued = frame->queued[worker];
+    int* queued_slots = frame->queued_slots[worker];
+    int cells[PROJECT_BATCH], slots[PROJECT_BATCH], shades[PROJECT_BATCH], nearest[PROJECT_BATCH];
+    float depths[PROJECT_BATCH];
+
+    int count = 0;
+    memset(bins->tile_end, 0, frame->num_tiles * sizeof(int));
+    for (int base = 0; base < glyph->count; base += PROJECT_BATCH) {
+        const int n = (glyph->count - base < PROJECT_BATCH) ? glyph->count - base : PROJECT_BATCH;
+        project_batch(glyph, base, n, &frame->transforms[index], ctx, frame->tiles_x, cells, depths, slots, shades);
+        const int survivors = collapse_runs(cells, depths, n, nearest);
+        for (int j = 0; j < survivors; j++) {
+            const int k = nearest[j];
+            queued_slots[count] = slots[k];
+            queued[count++] = (BinnedPoint){ depths[k], (unsigned char)slots[k], ctx->palette[shades[k]], ctx->object };
+            bins->tile_end[slots[k] >> 8]++;
+        }
+    }
+
+    // Stable counting sort: tile_end starts as each tile's first slot and is advanced past its points
+    for (int t = 0, start = 0; t < frame->num_tiles; t++) {
+        int n = bins->tile_end[t];
+        bins->tile_end[t] = start;
+        start += n;
+    }
+    for (int i = 0; i < count; i++) bins->points[bins->tile_end[queued_slots[i] >> 8]++] = queued[i];
+}
+
+/**
+ * @brief Tile job: resolves one tile against the Z-buffer, glyph after glyph.
+ */
+static void tile_job(void* data, int tile, int worker) {
+    (void)worker;
+    FrameJobs* frame = data;
+    const RenderContext* ctx = frame->ctx;
+    const int origin = (tile / frame->tiles_x) * TILE_H * ctx->sw + (tile % frame->tiles_x) * TILE_W;
+    for (int g = 0; g < frame->count; g++) {
+        const GlyphBins* bins = &frame->bins[g];
+        int start = tile > 0 ? bins->tile_end[tile - 1] : 0;
+        resolve_points(ctx, origin, bins->points + start, bins->tile_end[tile] - start);
+    }
+}
+
+/**
+ * @brief Draws `count` glyphs, glyph i placed by transforms[i] with contexts[i], on the workers of `jobs`.
+ * The frame is the same as drawing them in order with draw_glyph.
+ * @param ctx The context holding the frame's buffers; every context must share them.
+ * @return 1 on success, 0 if the frame's buffers could not be allocated.
+ */
+int draw_glyphs_parallel(FrameJobs* frame, JobSystem* jobs, const GlyphPoints* const* glyphs, const GlyphTransform* transforms,
+                         const RenderContext* const* contexts, int count, const RenderContext* ctx)
+{
+    frame->ctx = ctx;
+    frame->glyphs = glyphs;
+    frame->transforms = transforms;
+    frame->contexts = contexts;
+    frame->count = count;
+    frame->tiles_x = (ctx->sw + TILE_W - 1) / TILE_W;
+    frame->num_tiles = frame->tiles_x * ((ctx->sh + TILE_H - 1) / TILE_H);
+
+    // Every glyph may keep all of its points; a worker's buffers hold the largest glyph
+    int max_points = 0;
+    size_t bytes = arena_align(count * sizeof(GlyphBins));
+    for (int g = 0; g < count; g++) {
+        if (glyphs[g]->count > max_points) max_points = glyphs[g]->count;
+        bytes += arena_align(glyphs[g]->count * sizeof(BinnedPoint)) + arena_align(frame->num_tiles * sizeof(int));
+    }
+    bytes += jobs->num_workers * (arena_align(max_points * sizeof(BinnedPoint)) + arena_align(max_points * sizeof(int)));
+    if (bytes > frame->arena.capacity) bytes += bytes / ARENA_GROWTH_SLACK;
+    if (!arena_reserve(&frame->arena, bytes)) return 0;
+
+    frame->bins = arena_alloc(&frame->arena, count * sizeof(GlyphBins));
+    for (int g = 0; g < count; g++) {
+        frame->bins[g].points = arena_alloc(&frame->arena, glyphs[g]->count * sizeof(BinnedPoint));
+        frame->bins[g].tile_end = arena_alloc(&frame->arena, frame->num_tiles * sizeof(int));
+    }
+    for (int w = 0; w < jobs->num_workers; w++) {
+        frame->queued[w] = arena_alloc(&frame->arena, max_points * sizeof(BinnedPoint));
+        frame->queued_slots[w] = arena_alloc(&frame->arena, max_points * sizeof(int));
+    }
+
+    // The batches are separated by job_system_run's barrier: tiles need every glyph's bins
+    return job_system_run(jobs, glyph_job, frame, count) && job_system_run(jobs, tile_job, frame, frame->num_tiles);
+}
+
+void frame_jobs_free(FrameJobs* frame) {
+    arena_free(&frame->arena);
+}
+
+
+/**
+ * @brief Picks the level of detail for a glyph from its projected segment size.
+ * A glyph only moves to a coarser level once it is clearly below the threshold,
+ * and back to a finer one once it is clearly above it, so glyphs hovering
+ * around a threshold don't flicker between levels.
+ * @param seg_rows The projected segment size in screen rows.
+ * @param prev_lod The level the glyph used in the previous frame.
+ */
+int select_lod(float seg_rows, int prev_lod) {
+    int lod = prev_lod;
+    while (lod < LOD_STROKE && seg_rows < lod_min_rows[lod] * (1.0f - LOD_HYSTERESIS)) lod++;
+    while (lod > LOD_FULL && seg_rows > lod_min_rows[lod - 1] * (1.0f + LOD_HYSTERESIS)) lod--;
+    return lod;
+}
+
+/**
+ * @brief Feeds one measured render time to the quality controller.
+ * The density is coarsened as soon as the smoothed time exceeds the budget,
+ * and refined again, down to the requested density, when there is headroom.
+ */
+void quality_update(QualityController* qc, float render_ms) {
+    qc->avg_ms = (qc->avg_ms < 0) ? render_ms : qc->avg_ms * 0.8f + render_ms * 0.2f;
+    if (qc->settle > 0) {
+        qc->settle--;
+        return;
+    }
+
+    float new_density = qc->density;
+    if (qc->avg_ms > qc->budget_ms) {
+        // Never finer than requested, even when -d asks for a density coarser than the fallback limit
+        new_density = fminf(qc->density * QUALITY_STEP, fmaxf(QUALITY_MAX_DENSITY, qc->min_density));
+    } else if (qc->avg_ms < qc->budget_ms * QUALITY_HEADROOM) {
+        new_density = fmaxf(qc->density / QUALITY_STEP, qc->min_density);
+    }
+    if (new_density != qc->density) {
+        qc->density = new_density;
+        qc->avg_ms = -1.0f;
+        qc->settle = QUALITY_SETTLE_FRAMES;
+    }
+}
+
+
+// --- Orientation ---
+
+/**
+ * @brief The rotation by `angle` radians around the axis (ax, ay, az), which needs not be normalized.
+ * A zero axis gives the identity.
+ */
+Quaternion quat_axis_angle(float ax, float ay, float az, float angle) {
+    float len = sqrtf(ax * ax + ay * ay + az * az);
+    if (len < 1e-6f) return (Quaternion){ 1.0f, 0.0f, 0.0f, 0.0f };
+    float s = sinf(angle / 2.0f) / len;
+    return (Quaternion){ cosf(angle / 2.0f), ax * s, ay * s, az * s };
+}
+
+/**
+ * @brief Composes two rotations: the result applies `b` first, then `a`.
+ */
+Quaternion quat_mul(Quaternion a, Quaternion b) {
+    return (Quaternion){
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w
+    };
+}
+
+/**
+ * @brief Turns a quaternion, which needs not be normalized, into a rotation matrix.
+ */
+void quat_to_matrix(Quaternion q, float r[3][3]) {
+    float len = sqrtf(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+    float w = q.w / len, x = q.x / len, y = q.y / len, z = q.z / len;
+    r[0][0] = 1.0f - 2.0f * (y * y + z * z); r[0][1] = 2.0f * (x * y - w * z);        r[0][2] = 2.0f * (x * z + w * y);
+    r[1][0] = 2.0f * (x * y + w * z);        r[1][1] = 1.0f - 2.0f * (x * x + z * z); r[1][2] = 2.0f * (y * z - w * x);
+    r[2][0] = 2.0f * (x * z - w * y);        r[2][1] = 2.0f * (y * z + w * x);        r[2][2] = 1.0f - 2.0f * (x * x + y * y);
+}
+
+/**
+ * @brief Sets the context's per-frame transform from the object's orientation.
+ * The quaternion is normalized and turned into a rotation matrix once per
+ * frame; the italic shear (tilt_factor) is folded into the matrix applied to
+ * points, and the light (light_x, light_y) is turned into object space for the
+ * normals. Any orientation then costs one 3x3 transform per point, and
+ * lighting one dot product, whatever rotations it was composed from.
+ */
+void render_context_orient(RenderContext* ctx, Quaternion q) {
+    float (*r)[3] = ctx->rotation;
+    quat_to_matrix(q, r);
+    for (int i = 0; i < 3; i++) {
+        // x += y * tilt before the rotation moves part of the X column into the Y column
+        ctx->transform[i][0] = r[i][0];
+        ctx->transform[i][1] = r[i][1] + r[i][0] * ctx->tilt_factor;
+        ctx->transform[i][2] = r[i][2];
+        // The light lies in the camera's XY plane; the transpose brings it back into object space
+        ctx->light[i] = r[0][i] * ctx->light_x + r[1][i] * ctx->light_y;
+    }
+}
+
+
+/**
+ * @brief Produces an in-between frame by reprojecting the cells of a keyframe.
+ * Every lit keyframe cell is unprojected back to camera space from its stored
+ * depth, moved by the change in its object's orientation, tilt and position
+ * since the keyframe, and projected again with a Z-test. This costs one 3x3
+ * transform per screen cell instead of re-sampling every segment. Shading
+ * characters are carried over unchanged.
+ * @param key_zbuffer, key_bbuffer Depth and character buffers of the keyframe.
+ * @param key_obuffer The object of every keyframe cell; NULL if every cell is object 0.
+ * @param key_contexts The RenderContext of each object in the keyframe.
+ * @param contexts The RenderContext of each object for the current frame; the
+ *                 buffers of contexts[0] are drawn to and must be cleared.
+ */
+HOLO_TARGET_CLONES
+void warp_keyframe(const float* key_zbuffer, const char* key_bbuffer, const unsigned char* key_obuffer,
+                   const RenderContext* key_contexts, const RenderContext* contexts, int num_objects)
+{
+    // Change of every object's transform since the keyframe: D = R_now * S(t_now - t_key) * R_key^T.
+    // The shears are applied before the rotations, so with an unchanged tilt this is R_now * R_key^T.
+    float d[SCENE_MAX_OBJECTS][3][3];
+    for (int o = 0; o < num_objects; o++) {
+        const float (*r_key)[3] = key_contexts[o].rotation, (*r_now)[3] = contexts[o].rotation;
+        const float shear = contexts[o].tilt_factor - key_contexts[o].tilt_factor;
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                float back_x = r_key[j][0] + shear * r_key[j][1]; // S * R_key^T, column j
+                d[o][i][j] = r_now[i][0] * back_x + r_now[i][1] * r_key[j][1] + r_now[i][2] * r_key[j][2];
+            }
+        }
+    }
+
+    // Cells are unprojected with the keyframe's zoom and projected with the current one
+    const RenderContext* ctx = &contexts[0];
+    const float half_w = ctx->sw / 2.0f, half_h = ctx->sh / 2.0f;
+    const float key_zoom_x = key_contexts[0].zoom * 2.0f, key_zoom_y = key_contexts[0].zoom;
+    const float zoom_x = ctx->zoom * 2.0f, zoom_y = ctx->zoom;
+    for (int y = 0; y < ctx->sh; y++) {
+        for (int x = 0; x < ctx->sw; x++) {
+            int key_idx = x + ctx->sw * y;
+            float key_ooz = key_zbuffer[key_idx];
+            if (key_ooz <= 0) continue; // Empty cell
+            const int o = key_obuffer ? key_obuffer[key_idx] : 0;
+            const RenderContext *key = &key_contexts[o], *obj = &contexts[o];
+
+            // Unproject the cell center back to camera space, relative to its object's rotation origin
+            float z = reciprocal(key_ooz);
+            float cx = (x + 0.5f - half_w) * z / key_zoom_x - key->offset_x;
+            float cy = (half_h - y - 0.5f) * z / key_zoom_y - key->offset_y;
+            float cz = z - CAMERA_DISTANCE - key->offset_z;
+
+            // Rotate by the orientation delta, move to the object's current position and project again
+            float rot_x   = d[o][0][0] * cx + d[o][0][1] * cy + d[o][0][2] * cz + obj->offset_x;
+            float final_y = d[o][1][0] * cx + d[o][1][1] * cy + d[o][1][2] * cz + obj->offset_y;
+            float final_z = d[o][2][0] * cx + d[o][2][1] * cy + d[o][2][2] * cz + CAMERA_DISTANCE + obj->offset_z;
+            if (final_z <= 0) continue;
+
+            float ooz = reciprocal(final_z);
+            int xp = (int)(half_w + zoom_x * rot_x * ooz);
+            int yp = (int)(half_h - zoom_y * final_y * ooz);
+            int buffer_idx = xp + ctx->sw * yp;
+            if (xp < 0 || xp >= ctx->sw || yp < 0 || yp >= ctx->sh || ooz <= ctx->zbuffer[buffer_idx]) {
+                continue;
+            }
+            ctx->zbuffer[buffer_idx] = ooz;
+            ctx->bbuffer[buffer_idx] = key_bbuffer[key_idx];
+        }
+    }
+}
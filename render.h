@@ -0,0 +1,260 @@
+/**
+ * render.h - Point sampling, projection and Z-buffering of glyph segments
+ *
+ * Copyright (c) 2025 Olivier Coz
+ *
+ * This software is released under the MIT License.
+ * See the LICENSE file for details.
+ */
+
+#ifndef HOLO_RENDER_H
+#define HOLO_RENDER_H
+
+#include <stddef.h>
+#include "font.h"
+#include "jobs.h"
+#include "platform.h"
+
+#define CAMERA_DISTANCE 25.0f
+
+// Level-of-detail geometry, picked per glyph from the projected segment size
+#define LOD_FULL        0 // Flat faces and pointy ends at full density
+#define LOD_BOX         1 // Flat faces only, sampled at half density
+#define LOD_STROKE      2 // Four lines along the segment axis
+#define LOD_LEVELS      3
+#define LOD_HYSTERESIS  0.15f // Relative margin around each threshold to avoid popping
+
+// Adaptive quality: density is scaled up or down to keep render time within a budget
+#define QUALITY_STEP            1.25f // Factor applied to the density on each adjustment
+#define QUALITY_HEADROOM        0.6f  // Refine only when rendering takes less than this share of the budget
+#define QUALITY_SETTLE_FRAMES   8     // Frames measured after an adjustment before the next one
+#define QUALITY_MAX_DENSITY     1.0f  // Coarsest density the controller may fall back to, unless -d is coarser
+
+#define PROJECT_BATCH 256 // Points projected at once before the Z-buffer pass
+#define GLYPH_ARRAYS  6   // Coordinate arrays per compiled glyph (GlyphPoints)
+
+// Binning: projected points are sorted into screen tiles before they reach the buffers
+#define TILE_W            32 // Tile width in cells
+#define TILE_H            8  // Tile height in cells
+#define TILE_BIN_CAPACITY 64 // Points a tile holds before it is resolved
+
+#define SCENE_MAX_OBJECTS 16 // Text objects in one scene; a cell records its object in a byte
+
+// Function multiversioning: the hot loops get an AVX2 clone picked by the loader,
+// so a binary built for a generic x86-64 target still uses the wider units.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__) && !defined(HOLO_NO_MULTIVERSION)
+#define HOLO_TARGET_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define HOLO_TARGET_CLONES
+#endif
+
+
+// --- Data Structures ---
+
+/**
+ * @brief A rotation as a unit quaternion; w is the scalar part.
+ */
+typedef struct {
+    float w, x, y, z;
+} Quaternion;
+
+/**
+ * @brief A projected, shaded point waiting in a tile bin.
+ */
+typedef struct {
+    float         depth;  // 1/z, larger is nearer
+    unsigned char cell;   // Cell within the tile, row-major
+    char          ch;     // Palette character the point shades its cell with
+    unsigned char object; // Text object the point belongs to (see RenderContext.obuffer)
+} BinnedPoint;
+
+/**
+ * @brief Sorts projected points by screen tile so the buffers are written one tile at a time.
+ * Every tile covers TILE_H rows of TILE_W cells and queues its points in
+ * drawing order. A full tile, and every tile at the end of the frame, is
+ * resolved against the Z-buffer on its own, so that part of zbuffer and
+ * bbuffer stays in L1 however the glyphs are rotated.
+ */
+typedef struct {
+    int tiles_x, tiles_y;
+    BinnedPoint* bins; // TILE_BIN_CAPACITY points per tile
+    int* counts;       // Points queued in each tile
+} TileBinner;
+
+/**
+ * @brief Holds all necessary state for rendering a single frame.
+ * This includes screen buffers, dimensions, pre-calculated animation values,
+ * and configuration for geometry, projection, and lighting. Bundling this
+ * state prevents passing a dozen arguments to every rendering function.
+ * A scene of several text objects has one context per object, all sharing
+ * the same buffers.
+ */
+typedef struct {
+    // Buffers and screen dimensions
+    float* zbuffer;
+    char*  bbuffer;
+    unsigned char* obuffer; // Object of every lit cell, for warping a keyframe; NULL when not needed
+    int    sw, sh;
+    TileBinner* binner; // Where draw_glyph queues its points; NULL to write the buffers directly
+
+    // Pre-calculated transform of the object drawn, for the current frame (see render_context_orient)
+    float rotation[3][3];               // Orientation: rows map an object-space direction to camera X, Y and Z
+    float transform[3][3];              // The orientation with the italic shear folded in, applied to points
+    float light[3];                     // Light direction in object space, so normals are lit unrotated
+    float offset_x, offset_y, offset_z; // Object position, added after its rotation
+    unsigned char object;               // Index of the object in the scene
+
+    // Configuration for geometry and projection
+    float zoom;
+    float tilt_factor; // Italic shear of x by y, folded into `transform`
+
+    // Configuration for lighting and appearance
+    float light_x, light_y, contrast; // Light in camera space, turned into `light`
+    const char* palette;
+    size_t palette_len;
+} RenderContext;
+
+/**
+ * @brief Feedback controller that trades sampling density for render time.
+ * Render times are smoothed, and after every change the controller waits a few
+ * frames so it reacts to the new cost rather than to the one it just corrected.
+ */
+typedef struct {
+    float budget_ms;   // Target render time per frame; 0 disables the controller
+    float min_density; // Finest density allowed (the one requested with -d)
+    float density;     // Density used for the next frame
+    float avg_ms;      // Smoothed render time, negative until the first sample
+    int   settle;      // Frames left before the next adjustment is allowed
+} QualityController;
+
+/**
+ * @brief A sample point on a segment's surface, in segment-local space.
+ */
+typedef struct {
+    float x, y, z;    // Position relative to the segment center
+    float nx, ny, nz; // Surface normal for lighting
+} SegmentPoint;
+
+/**
+ * @brief The sampled surface of one segment length at one level of detail.
+ */
+typedef struct {
+    const SegmentPoint* points;
+    int count;
+} PointTemplate;
+
+/**
+ * @brief The points of a compiled glyph, one array per coordinate.
+ * Split so the batched projection in draw_glyph reads each coordinate with
+ * unit stride and can be vectorized.
+ */
+typedef struct {
+    const float *x, *y, *z;    // Character-local positions
+    const float *nx, *ny, *nz; // Unit normals
+    int count;
+} GlyphPoints;
+
+/**
+ * @brief Where a glyph is drawn this frame: the object's transform composed with the glyph's own placement.
+ * Built once per glyph (glyph_transform), so per-glyph motion such as waves,
+ * flips or spins costs nothing per point.
+ */
+typedef struct {
+    float m[3][3];  // Character-local point to camera space, shear included
+    float t[3];     // Camera-space position of the glyph's origin, CAMERA_DISTANCE included
+    float light[3]; // Light direction in character-local space
+} GlyphTransform;
+
+/**
+ * @brief Point templates for every segment length class of the font.
+ * Segments with the same length share a template and only differ by their
+ * transform, so the cache holds a few templates instead of 14 point sets.
+ */
+typedef struct {
+    float density;                                     // Sampling step the templates were built for; 0 if empty
+    int   num_classes;                                 // Distinct segment lengths
+    int   segment_class[NUM_SEGMENTS];                 // Length class of each segment
+    PointTemplate templates[NUM_SEGMENTS][LOD_LEVELS]; // [class][lod]
+    int   num_lods;                                    // Levels actually sampled, from LOD_FULL
+    float class_lengths[NUM_SEGMENTS];                 // Length of each class
+    float seg_w, seg_t, point_len;                     // Cross-section the templates were sampled with
+    Arena arena;                                       // Owns every template's points
+} SegmentTemplates;
+
+/**
+ * @brief Merged point sets of the glyphs in use, compiled from the segment templates.
+ * Each glyph's active segments are instantiated once in character-local space.
+ * Glyphs are compiled the first time they are drawn at the current density.
+ * Characters that are changing are drawn segment by segment instead, from
+ * the separately compiled segments.
+ */
+typedef struct {
+    float density;                                      // Density of the templates the glyphs came from; 0 if empty
+    unsigned char compiled[SUPPORTED_CHARS];            // Whether glyphs[c] holds current points
+    GlyphPoints glyphs[SUPPORTED_CHARS][LOD_LEVELS];    // [char - ASCII_OFFSET][lod], character-local space
+    Arena arena;                                        // Owns every compiled glyph's points
+    float segment_density;                              // Density `segments` were compiled for; 0 if empty
+    GlyphPoints segments[NUM_SEGMENTS][LOD_LEVELS];     // Every segment alone (glyph_cache_prepare_segments)
+    Arena segment_arena;                                // Owns the segments' points
+} GlyphCache;
+
+/**
+ * @brief The visible points of one glyph, grouped by screen tile, waiting for the tile jobs.
+ */
+typedef struct {
+    BinnedPoint* points; // Drawing order within each tile
+    int* tile_end;       // End of each tile's points in `points`
+} GlyphBins;
+
+/**
+ * @brief A frame's glyphs drawn as jobs: one per glyph, then one per tile.
+ * Glyph jobs project, collapse and shade their points and group them by
+ * tile. Tile jobs then resolve their tile against the Z-buffer, glyph after
+ * glyph, so every cell sees its points in the same order as draw_glyph would
+ * and the frame does not depend on the thread count. Glyphs of several text
+ * objects share a frame, each drawn with its object's context.
+ */
+typedef struct {
+    const RenderContext* ctx;              // Buffers of the frame
+    const GlyphPoints* const* glyphs;
+    const GlyphTransform* transforms;      // Placement of every glyph
+    const RenderContext* const* contexts;  // The object every glyph is drawn with
+    int count;
+    int tiles_x, num_tiles;
+    GlyphBins* bins;                       // One per glyph
+    BinnedPoint* queued[JOBS_MAX_WORKERS]; // Per worker: a glyph's survivors in drawing order
+    int* queued_slots[JOBS_MAX_WORKERS];   // Their tile and cell (see bin_point)
+    Arena arena;                           // Owns the bins and the per-worker buffers
+} FrameJobs;
+
+
+// --- Core Rendering Functions ---
+
+int segment_templates_build(SegmentTemplates* templates, const float segment_lengths[NUM_SEGMENTS],
+                            float seg_w, float seg_t, float point_len, float density, int num_lods);
+void segment_templates_free(SegmentTemplates* templates);
+int glyph_cache_prepare(GlyphCache* cache, const SegmentTemplates* templates, const SegmentDef seg_defs[NUM_SEGMENTS],
+                        const char* text);
+int glyph_cache_prepare_segments(GlyphCache* cache, const SegmentTemplates* templates,
+                                 const SegmentDef seg_defs[NUM_SEGMENTS]);
+void glyph_cache_free(GlyphCache* cache);
+void glyph_transform(const RenderContext* ctx, const float local[3][3], float x, float y, float z, GlyphTransform* xf);
+void segment_transform(const GlyphTransform* glyph, const float local[3][3], float scale, float cx, float cy,
+                       GlyphTransform* xf);
+void draw_glyph(const GlyphPoints* glyph, const GlyphTransform* xf, const RenderContext* ctx);
+size_t tile_binner_arena_size(int sw, int sh);
+void tile_binner_resize(TileBinner* binner, Arena* arena, int sw, int sh);
+void tile_binner_flush(const RenderContext* ctx);
+int draw_glyphs_parallel(FrameJobs* frame, JobSystem* jobs, const GlyphPoints* const* glyphs, const GlyphTransform* transforms,
+                         const RenderContext* const* contexts, int count, const RenderContext* ctx);
+void frame_jobs_free(FrameJobs* frame);
+int select_lod(float seg_rows, int prev_lod);
+void quality_update(QualityController* qc, float render_ms);
+Quaternion quat_axis_angle(float ax, float ay, float az, float angle);
+Quaternion quat_mul(Quaternion a, Quaternion b);
+void quat_to_matrix(Quaternion q, float r[3][3]);
+void render_context_orient(RenderContext* ctx, Quaternion orientation);
+void warp_keyframe(const float* key_zbuffer, const char* key_bbuffer, const unsigned char* key_obuffer,
+                   const RenderContext* key_contexts, const RenderContext* contexts, int num_objects);
+
+#endif // HOLO_RENDER_H
@@ -0,0 +1,241 @@
+/**
+ * timeline.c - Keyframed animation timelines read from a text file
+ *
+ * Copyright (c) 2025 Olivier Coz
+ *
+ * This software is released under the MIT License.
+ * See the LICENSE file for details.
+ */
+
+#include "timeline.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static const char* const track_names[TRACK_TYPES] = { "pitch", "yaw", "roll", "tilt", "zoom", "light", "text" };
+static const char* const easing_names[] = { "linear", "ease-in", "ease-out", "ease-in-out", "step" };
+
+
+// --- Easing ---
+
+/**
+ * @brief Maps the progress `u` in [0, 1] between two keys through an easing curve.
+ */
+static float ease(Easing easing, float u) {
+    switch (easing) {
+        case EASE_IN:     return u * u * u;
+        case EASE_OUT:    { float v = 1.0f - u; return 1.0f - v * v * v; }
+        case EASE_IN_OUT: { if (u < 0.5f) return 4.0f * u * u * u; float v = 2.0f - 2.0f * u; return 1.0f - v * v * v / 2.0f; }
+        case EASE_STEP:   return 0.0f;
+        case EASE_LINEAR: default: return u;
+    }
+}
+
+
+// --- Loading ---
+
+/**
+ * @brief The track of `type` for `object`, created on first use.
+ * @return The track, or NULL if the memory could not be allocated.
+ */
+static TimelineTrack* find_track(Timeline* timeline, int object, TrackType type) {
+    for (int i = 0; i < timeline->num_tracks; i++) {
+        if (timeline->tracks[i].object == object && timeline->tracks[i].type == type) return &timeline->tracks[i];
+    }
+    TimelineTrack* tracks = realloc(timeline->tracks, (timeline->num_tracks + 1) * sizeof(TimelineTrack));
+    if (!tracks) return NULL;
+    timeline->tracks = tracks;
+    TimelineTrack* track = &tracks[timeline->num_tracks++];
+    *track = (TimelineTrack){ .object = object, .type = type };
+    if (object > timeline->max_object) timeline->max_object = object;
+    return track;
+}
+
+/**
+ * @brief Inserts a key after every key of the track that is not later, so keys at the same time keep file order.
+ * @return 1 on success, 0 if the memory could not be allocated.
+ */
+static int insert_key(TimelineTrack* track, const TimelineKey* key) {
+    if (track->count == track->capacity) {
+        int capacity = track->capacity > 0 ? track->capacity * 2 : 8;
+        TimelineKey* keys = realloc(track->keys, capacity * sizeof(TimelineKey));
+        if (!keys) return 0;
+        track->keys = keys;
+        track->capacity = capacity;
+    }
+    int i = track->count;
+    while (i > 0 && track->keys[i - 1].time > key->time) {
+        track->keys[i] = track->keys[i - 1];
+        i--;
+    }
+    track->keys[i] = *key;
+    track->count++;
+    return 1;
+}
+
+/**
+ * @brief Reads one line of a timeline file into the timeline.
+ * @param object The object the following keys animate; updated by `object` lines.
+ * @return NULL on success, or a description of what is wrong with the line.
+ */
+static const char* parse_line(Timeline* timeline, char* line, int* object) {
+    const char* separators = " \t\r\n";
+    char* first = strtok(line, separators);
+    if (!first || first[0] == '#') return NULL; // Blank line or comment
+
+    if (strcmp(first, "object") == 0) {
+        char* arg = strtok(NULL, separators);
+        if (!arg || sscanf(arg, "%d", object) != 1 || *object < 0) return "expected an object number";
+        return NULL;
+    }
+    if (strcmp(first, "loop") == 0) {
+        char* arg = strtok(NULL, separators);
+        if (!arg || sscanf(arg, "%f", &timeline->loop) != 1 || timeline->loop <= 0) return "expected a loop length in seconds";
+        return NULL;
+    }
+
+    TimelineKey key = { .easing = EASE_LINEAR };
+    if (sscanf(first, "%f", &key.time) != 1 || key.time < 0) return "expected a time in seconds, object or loop";
+    char* name = strtok(NULL, separators);
+    int type = 0;
+    while (type < TRACK_TYPES && (!name || strcmp(name, track_names[type]) != 0)) type++;
+    if (type == TRACK_TYPES) return "expected pitch, yaw, roll, tilt, zoom, light or text";
+
+    // Zoom and light belong to the scene, whatever object the lines before selected
+    int track_object = (type == TRACK_ZOOM || type == TRACK_LIGHT) ? 0 : *object;
+    if (type == TRACK_TEXT) {
+        // The rest of the line is the text; an empty one shows the date and time
+        char* text = strtok(NULL, "\r\n");
+        while (text && (*text == ' ' || *text == '\t')) text++;
+        if (text && *text) {
+            if (!(key.text = malloc(strlen(text) + 1))) return "out of memory";
+            strcpy(key.text, text);
+        }
+        key.easing = EASE_STEP;
+    } else {
+        char* value = strtok(NULL, separators);
+        int wanted = (type == TRACK_LIGHT) ? 2 : 1;
+        if (!value || sscanf(value, "%f,%f", &key.value[0], &key.value[1]) != wanted) {
+            return (type == TRACK_LIGHT) ? "expected a light vector x,y" : "expected a value";
+        }
+        char* easing = strtok(NULL, separators);
+        if (easing) {
+            int e = 0;
+            while (e <= EASE_STEP && strcmp(easing, easing_names[e]) != 0) e++;
+            if (e > EASE_STEP) return "expected linear, ease-in, ease-out, ease-in-out or step";
+            key.easing = (Easing)e;
+        }
+    }
+
+    TimelineTrack* track = find_track(timeline, track_object, (TrackType)type);
+    if (!track || !insert_key(track, &key)) {
+        free(key.text);
+        return "out of memory";
+    }
+    return NULL;
+}
+
+/**
+ * @brief Reads a timeline file.
+ * Every line is a key, `<seconds> <property> <value> [easing]`, or a
+ * directive: `object <n>` makes the following keys animate object n (0 is the
+ * text of the command line, then one per -O), and `loop <seconds>` restarts
+ * the timeline after that long. Text keys take the rest of the line as their
+ * text and switch at their time. '#' starts a comment line.
+ * @return 1 on success, 0 on an unreadable or invalid file (reported on stderr).
+ */
+int timeline_load(Timeline* timeline, const char* path) {
+    *timeline = (Timeline){0};
+    FILE* in = fopen(path, "r");
+    if (!in) {
+        fprintf(stderr, "Cannot read timeline %s\n", path);
+        return 0;
+    }
+
+    char line[TIMELINE_MAX_LINE];
+    int line_no = 0, object = 0;
+    const char* error = NULL;
+    while (!error && fgets(line, sizeof(line), in)) {
+        line_no++;
+        if (!strchr(line, '\n') && !feof(in)) error = "line too long";
+        else error = parse_line(timeline, line, &object);
+    }
+    fclose(in);
+    if (error) {
+        fprintf(stderr, "%s:%d: %s\n", path, line_no, error);
+        timeline_free(timeline);
+        return 0;
+    }
+    return 1;
+}
+
+void timeline_free(Timeline* timeline) {
+    for (int i = 0; i < timeline->num_tracks; i++) {
+        for (int k = 0; k < timeline->tracks[i].count; k++) free(timeline->tracks[i].keys[k].text);
+        free(timeline->tracks[i].keys);
+    }
+    free(timeline->tracks);
+    *timeline = (Timeline){0};
+}
+
+
+// --- Evaluation ---
+
+/**
+ * @brief Evaluates one property at `t` seconds from the start.
+ * Before the first key a track holds its first value, after the last key its
+ * last one; in between it eases from one key to the next.
+ * @param[out] value The property's value (both components for TRACK_LIGHT).
+ * @param[out] text For TRACK_TEXT, the text, or NULL for the date and time.
+ * @return 1 if the timeline animates the property, 0 if it is left alone.
+ */
+int timeline_sample(const Timeline* timeline, int object, TrackType type, float t, float value[2], const char** text) {
+    const TimelineTrack* track = NULL;
+    for (int i = 0; i < timeline->num_tracks && !track; i++) {
+        if (timeline->tracks[i].object == object && timeline->tracks[i].type == type) track = &timeline->tracks[i];
+    }
+    if (!track) return 0;
+    if (timeline->loop > 0) t = fmodf(t, timeline->loop);
+
+    // First key strictly after t
+    int lo = 0, hi = track->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (track->keys[mid].time > t) hi = mid;
+        else lo = mid + 1;
+    }
+    const TimelineKey* prev = &track->keys[lo > 0 ? lo - 1 : 0];
+    if (type == TRACK_TEXT) {
+        *text = prev->text;
+        return 1;
+    }
+    value[0] = prev->value[0];
+    value[1] = prev->value[1];
+    if (lo > 0 && lo < track->count) {
+        const TimelineKey* next = &track->keys[lo];
+        float u = ease(next->easing, (t - prev->time) / (next->time - prev->time));
+        value[0] += (next->value[0] - prev->value[0]) * u;
+        value[1] += (next->value[1] - prev->value[1]) * u;
+    }
+    return 1;
+}
+
+/**
+ * @brief Longest text the timeline gives `object`, for sizing its per-glyph state.
+ * @param clock_len The length to count for keys that show the date and time.
+ * @return The length, or 0 if the object's text is not animated.
+ */
+size_t timeline_max_text_len(const Timeline* timeline, int object, size_t clock_len) {
+    size_t max_len = 0;
+    for (int i = 0; i < timeline->num_tracks; i++) {
+        const TimelineTrack* track = &timeline->tracks[i];
+        if (track->object != object || track->type != TRACK_TEXT) continue;
+        for (int k = 0; k < track->count; k++) {
+            size_t len = track->keys[k].text ? strlen(track->keys[k].text) : clock_len;
+            if (len > max_len) max_len = len;
+        }
+    }
+    return max_len;
+}
@@ -0,0 +1,75 @@
+/**
+ * timeline.h - Keyframed animation timelines read from a text file
+ *
+ * Copyright (c) 2025 Olivier Coz
+ *
+ * This software is released under the MIT License.
+ * See the LICENSE file for details.
+ */
+
+#ifndef HOLO_TIMELINE_H
+#define HOLO_TIMELINE_H
+
+#include <stddef.h>
+
+#define TIMELINE_MAX_LINE 512 // Longest line of a timeline file, newline included
+
+/**
+ * @brief How a track moves from the previous key to the next one.
+ */
+typedef enum {
+    EASE_LINEAR,
+    EASE_IN,     // Starts slowly (cubic)
+    EASE_OUT,    // Ends slowly (cubic)
+    EASE_IN_OUT, // Starts and ends slowly (cubic)
+    EASE_STEP    // Holds the previous value until the key's time
+} Easing;
+
+/**
+ * @brief The animated properties. Zoom and light apply to the whole scene, the others to one object.
+ */
+typedef enum {
+    TRACK_PITCH, // Degrees
+    TRACK_YAW,   // Degrees
+    TRACK_ROLL,  // Degrees
+    TRACK_TILT,  // Italic shear factor
+    TRACK_ZOOM,  // Zoom, as with -z
+    TRACK_LIGHT, // Light vector x,y
+    TRACK_TEXT,  // Text; none for the date and time
+    TRACK_TYPES
+} TrackType;
+
+typedef struct {
+    float  time;     // Seconds from the start of the timeline
+    float  value[2]; // Only TRACK_LIGHT uses both
+    char*  text;     // TRACK_TEXT only; NULL for the date and time
+    Easing easing;   // How the track reaches this key
+} TimelineKey;
+
+/**
+ * @brief The keys of one property of one object, in time order.
+ */
+typedef struct {
+    int object;
+    TrackType type;
+    TimelineKey* keys;
+    int count, capacity;
+} TimelineTrack;
+
+/**
+ * @brief Every track of a timeline file.
+ * Properties without a track keep following the command line options.
+ */
+typedef struct {
+    TimelineTrack* tracks;
+    int num_tracks;
+    int max_object;  // Highest object index any track animates
+    float loop;      // Seconds after which the timeline starts over; 0 holds the last keys
+} Timeline;
+
+int timeline_load(Timeline* timeline, const char* path);
+void timeline_free(Timeline* timeline);
+int timeline_sample(const Timeline* timeline, int object, TrackType type, float t, float value[2], const char** text);
+size_t timeline_max_text_len(const Timeline* timeline, int object, size_t clock_len);
+
+#endif // HOLO_TIMELINE_H